@@ -0,0 +1,148 @@
+#define FMT_HEADER_ONLY
+
+// Compares Token::is_keyword, a perfect hash over the keyword list, with the
+// chain of string comparisons it replaced, on the words of a dl program
+
+#include <chrono>
+#include <cstddef>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include <fmt/format.h>
+
+#include "Token.hpp"
+
+namespace
+{
+
+constexpr std::size_t rounds = 20'000;
+
+constexpr std::string_view program = R"(
+include "stdio.h"
+
+struct Iterator {
+    i32 cursor
+    i32* data
+}
+
+enum Shape {
+    Circle(i32)
+    Square(i32, i32)
+}
+
+fn area(Shape shape) -> i32 {
+    match shape {
+        Shape::Circle(radius) => { return 3 * radius * radius }
+        Shape::Square(width, height) => { return width * height }
+    }
+    return 0
+}
+
+fn sum(mut Iterator* it, i32 count) -> i32 {
+    mut i32 total = 0
+    for (mut i32 i = 0; i < count; i += 1) {
+        if (it->data[i] > 0 and total < 1000) {
+            total += it->data[i]
+        }
+    }
+    while (it->cursor < count or false) {
+        it->cursor += 1
+    }
+    return total
+}
+
+fn main(i32 argc, char** argv) -> i32 {
+    mut i32[4] values = [4, 8, 15, 16]
+    mut Iterator it = Iterator::create(0, values)
+    printf("%d %d\n", sum(&it, 4), area(Shape::Circle(argc)))
+    return true
+}
+)";
+
+// The lookup Token::is_keyword used before the perfect hash
+std::optional<Token::Type> is_keyword_chain(const std::string& lexeme) noexcept
+{
+    if (lexeme == "fn") { return Token::Type::FN; }
+    if (lexeme == "if") { return Token::Type::IF; }
+    if (lexeme == "mut") { return Token::Type::MUT; }
+    if (lexeme == "return") { return Token::Type::RETURN; }
+    if (lexeme == "while") { return Token::Type::WHILE; }
+    if (lexeme == "for") { return Token::Type::FOR; }
+    if (lexeme == "include") { return Token::Type::C_INCLUDE; }
+    if (lexeme == "struct") { return Token::Type::STRUCT; }
+    if (lexeme == "true") { return Token::Type::TRUE; }
+    if (lexeme == "false") { return Token::Type::FALSE; }
+    if (lexeme == "class") { return Token::Type::CLASS; }
+    if (lexeme == "and") { return Token::Type::AND; }
+    if (lexeme == "or") { return Token::Type::OR; }
+    if (lexeme == "enum") { return Token::Type::ENUM; }
+    if (lexeme == "match") { return Token::Type::MATCH; }
+    if (lexeme == "module") { return Token::Type::MODULE; }
+    if (lexeme == "import") { return Token::Type::IMPORT; }
+    return {};
+}
+
+// The words the lexer would look up, identifiers and keywords alike
+std::vector<std::string_view> split_words(const std::string_view text)
+{
+    const auto is_word_char = [](const char c) {
+        return c == '_' || (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9');
+    };
+
+    std::vector<std::string_view> words;
+    std::size_t                   start = 0;
+    for (std::size_t i = 0; i <= text.size(); ++i) {
+        if (i < text.size() && is_word_char(text[i])) { continue; }
+        if (i > start && !(text[start] >= '0' && text[start] <= '9')) {
+            words.push_back(text.substr(start, i - start));
+        }
+        start = i + 1;
+    }
+    return words;
+}
+
+// Runs `lookup` over every word `rounds` times, returning the nanoseconds
+// per lookup and the number of keywords found so the work is not elided
+template <typename Words, typename Lookup>
+std::pair<double, std::size_t> measure(const Words& words, Lookup lookup)
+{
+    std::size_t found = 0;
+
+    const auto start = std::chrono::steady_clock::now();
+    for (std::size_t round = 0; round < rounds; ++round) {
+        for (const auto& word : words) {
+            if (lookup(word)) { ++found; }
+        }
+    }
+    const auto elapsed = std::chrono::steady_clock::now() - start;
+
+    const auto lookups = static_cast<double>(rounds * words.size());
+    return {static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()) / lookups,
+            found};
+}
+
+} // namespace
+
+int main()
+{
+    const auto views = split_words(program);
+    // The old lookup took a std::string, built once here so only the lookup
+    // itself is timed
+    const std::vector<std::string> strings(views.begin(), views.end());
+
+    const auto [hash_ns, hash_found] = measure(views, [](const std::string_view word) {
+        return Token::is_keyword(word).has_value();
+    });
+    const auto [chain_ns, chain_found] =
+        measure(strings, [](const std::string& word) { return is_keyword_chain(word).has_value(); });
+
+    fmt::print("{} words, {} lookups each\n", views.size(), rounds);
+    fmt::print("perfect hash     {:7.2f} ns/lookup ({} keywords)\n", hash_ns, hash_found);
+    fmt::print("comparison chain {:7.2f} ns/lookup ({} keywords)\n", chain_ns, chain_found);
+    fmt::print("speedup          {:7.2f}x\n", chain_ns / hash_ns);
+
+    return hash_found == chain_found ? 0 : 1;
+}
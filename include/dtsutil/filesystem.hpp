@@ -5,7 +5,20 @@
 #include <expected>
 #include <filesystem>
 #include <fstream>
+#include <iterator>
+#include <memory>
+#include <optional>
+#include <string>
 #include <string_view>
+#include <utility>
+
+#if defined(__unix__) || (defined(__APPLE__) && defined(__MACH__))
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define DTSUTIL_HAS_MMAP
+#endif
 
 namespace dts {
 
@@ -15,6 +28,76 @@ enum class FileStreamError : std::uint64_t {
     UnableToOpen
 };
 
+// Read-only view over a file's contents. Regular files are memory-mapped,
+// anything else (pipes, character devices, platforms without mmap) is read
+// into an owned buffer. Either way `view()` stays valid for the lifetime of
+// the object, moving it does not invalidate the view.
+class [[nodiscard]] MappedFile {
+  public:
+    MappedFile() noexcept = default;
+
+    explicit MappedFile(std::string contents) noexcept
+      : m_owned{ std::make_unique<std::string>(std::move(contents)) } {}
+
+    MappedFile(const MappedFile&)                    = delete;
+    auto operator=(const MappedFile&) -> MappedFile& = delete;
+
+    MappedFile(MappedFile&& other) noexcept
+      : m_mapping{ std::exchange(other.m_mapping, nullptr) },
+        m_size{ std::exchange(other.m_size, 0) },
+        m_owned{ std::move(other.m_owned) } {}
+
+    auto operator=(MappedFile&& other) noexcept -> MappedFile& {
+        if (this != &other) {
+            unmap();
+            m_mapping = std::exchange(other.m_mapping, nullptr);
+            m_size    = std::exchange(other.m_size, 0);
+            m_owned   = std::move(other.m_owned);
+        }
+        return *this;
+    }
+
+    ~MappedFile() noexcept { unmap(); }
+
+    [[nodiscard]] auto view() const noexcept -> std::string_view {
+        if (m_owned) { return *m_owned; }
+        return { static_cast<const char*>(m_mapping), m_size };
+    }
+
+    [[nodiscard]] auto is_mapped() const noexcept -> bool {
+        return m_mapping != nullptr;
+    }
+
+#ifdef DTSUTIL_HAS_MMAP
+    [[nodiscard]] static auto map(const int fd, const std::size_t size) noexcept
+      -> std::optional<MappedFile> {
+        void* mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapping == MAP_FAILED) { return {}; }
+
+        // Sources are lexed front to back exactly once
+        madvise(mapping, size, MADV_SEQUENTIAL);
+
+        MappedFile file;
+        file.m_mapping = mapping;
+        file.m_size    = size;
+        return file;
+    }
+#endif
+
+  private:
+    void unmap() noexcept {
+#ifdef DTSUTIL_HAS_MMAP
+        if (m_mapping != nullptr) { munmap(m_mapping, m_size); }
+#endif
+        m_mapping = nullptr;
+        m_size    = 0;
+    }
+
+    void*                        m_mapping = nullptr;
+    std::size_t                  m_size    = 0;
+    std::unique_ptr<std::string> m_owned   = nullptr;
+};
+
 [[nodiscard]] inline auto read_file(const std::string_view raw_path) noexcept
   -> std::expected<std::string, FileStreamError> {
     const auto path = std::filesystem::path(raw_path);
@@ -36,6 +119,51 @@ enum class FileStreamError : std::uint64_t {
     // clang-format on
 }
 
+// Like `read_file`, but avoids copying regular files: they are mapped
+// read-only and handed out as a view. Non-regular files fall back to a
+// buffered read, so `dl` can still be fed through a pipe.
+[[nodiscard]] inline auto map_file(const std::string_view raw_path) noexcept
+  -> std::expected<MappedFile, FileStreamError> {
+    const auto path = std::filesystem::path(raw_path);
+
+    std::error_code error;
+    const auto      status = std::filesystem::status(path, error);
+    if (error || !std::filesystem::exists(status)) {
+        return std::unexpected(FileStreamError::NoSuchFile);
+    }
+
+#ifdef DTSUTIL_HAS_MMAP
+    if (status.type() == std::filesystem::file_type::regular) {
+        const int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) { return std::unexpected(FileStreamError::UnableToOpen); }
+
+        struct stat file_stat {};
+        if (fstat(fd, &file_stat) != 0) {
+            close(fd);
+            return std::unexpected(FileStreamError::UnableToOpen);
+        }
+
+        // mmap refuses zero-length mappings, an empty file is just empty
+        const auto size = static_cast<std::size_t>(file_stat.st_size);
+        if (size == 0) {
+            close(fd);
+            return MappedFile(std::string{});
+        }
+
+        auto mapped_file = MappedFile::map(fd, size);
+        close(fd);
+        if (mapped_file) { return std::move(*mapped_file); }
+    }
+#endif
+
+    std::ifstream file_handle(path, std::ios::binary);
+    if (!file_handle) { return std::unexpected(FileStreamError::UnableToOpen); }
+
+    return MappedFile(std::string(
+      std::istreambuf_iterator<char>(file_handle), std::istreambuf_iterator<char>()
+    ));
+}
+
 } // namespace dts
 
 namespace dts::detail {
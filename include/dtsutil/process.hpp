@@ -2,118 +2,368 @@
 #define DTSUTIL_PROCESS_HPP
 
 #include <algorithm>
+#include <array>
 #include <cerrno>
+#include <chrono>
+#include <csignal>
+#include <cstdint>
 #include <cstring>
 #include <expected>
 #include <optional>
-#include <ranges>
+#include <string>
+#include <string_view>
+#include <utility>
 #include <vector>
 
 #if defined(__unix__) || (defined(__APPLE__) && defined(__MACH__))
+#include <fcntl.h>
+#include <poll.h>
+#include <spawn.h>
+#include <sys/wait.h>
 #include <unistd.h>
+#define DTSUTIL_HAS_POSIX_SPAWN
+
+#if defined(__linux__)
+#define DTSUTIL_HAS_PIPE2
 #else
-#include <windows.h>
+#include <mutex>
+#endif
+
+extern char** environ;
 #endif
 
 namespace dts {
 
 struct [[nodiscard]] ProcessError {
-    enum class ErrorType : std::uint8_t { EmptyCommand = 0, ForkFailed };
+    enum class ErrorType : std::uint8_t {
+        EmptyCommand = 0,
+        SpawnFailed,
+        PipeFailed,
+        WriteFailed,
+        ReadFailed,
+        WaitFailed,
+    };
 
     ErrorType                  type;
     std::optional<std::string> message;
 };
 
+struct [[nodiscard]] ProcessOptions {
+    // Give the child a pipe as stdin, written through Process::write()
+    bool pipe_stdin = false;
 
-namespace detail {
+    // Collect the child's stdout and stderr into the ProcessResult instead
+    // of letting it inherit ours
+    bool capture_output = false;
 
-class [[nodiscard]] ShellCommand {
-  public:
-    [[nodiscard]] static auto create(const std::string& command) noexcept
-      -> ShellCommand {
-        return ShellCommand(command);
-    }
+    // Kill the child if it has not exited this long after being spawned
+    std::optional<std::chrono::milliseconds> timeout;
+};
+
+struct [[nodiscard]] ProcessResult {
+    int         pid       = -1;
+    int         exit_code = 0;
+    bool        timed_out = false;
+    std::string stdout_output;
+    std::string stderr_output;
 
-    [[nodiscard]] auto program_name() const noexcept -> std::string {
-        return m_command.front();
+    [[nodiscard]] auto success() const noexcept -> bool {
+        return !timed_out && exit_code == 0;
     }
+};
+
+#ifdef DTSUTIL_HAS_POSIX_SPAWN
+
+// A running child process. Arguments are passed to the program as given,
+// nothing is split or interpreted by a shell. Every Process only ever waits
+// for its own pid, so any number of them can run at the same time.
+class [[nodiscard]] Process {
+  public:
+    [[nodiscard]] static auto
+    spawn(const std::vector<std::string>& arguments, const ProcessOptions& options = {}) noexcept
+      -> std::expected<Process, ProcessError> {
+        if (arguments.empty() || arguments.front().empty()) {
+            return std::unexpected(
+              ProcessError(ProcessError::ErrorType::EmptyCommand, {})
+            );
+        }
+
+        std::vector<char*> argv;
+        argv.reserve(arguments.size() + 1);
+        for (const auto& argument : arguments) {
+            argv.push_back(const_cast<char*>(argument.c_str()));
+        }
+        argv.push_back(nullptr);
+
+        Process process(options);
 
-    [[nodiscard]] auto command() const noexcept
-      -> const std::vector<std::string>& {
-        return { m_command };
+        // { read end, write end } for stdin, stdout and stderr
+        std::array<std::array<int, 2>, 3> pipes{
+            { { -1, -1 }, { -1, -1 }, { -1, -1 } }
+        };
+        const auto close_pipes = [&pipes]() noexcept {
+            for (auto& ends : pipes) {
+                for (auto& fd : ends) {
+                    if (fd >= 0) { close(fd); }
+                    fd = -1;
+                }
+            }
+        };
+
+        const std::array<bool, 3> wanted{ options.pipe_stdin,
+                                          options.capture_output,
+                                          options.capture_output };
+
+#ifndef DTSUTIL_HAS_PIPE2
+        // Pipes only become close-on-exec after they are created, no other
+        // thread may spawn until this child holds its own ends
+        const std::scoped_lock spawn_lock{ spawn_mutex() };
+#endif
+        for (std::size_t stream = 0; stream < pipes.size(); ++stream) {
+            if (!wanted[stream]) { continue; }
+            if (!make_pipe(pipes[stream])) {
+                const auto error = errno;
+                close_pipes();
+                return std::unexpected(ProcessError(
+                  ProcessError::ErrorType::PipeFailed, std::strerror(error)
+                ));
+            }
+        }
+
+        posix_spawn_file_actions_t actions;
+        posix_spawn_file_actions_init(&actions);
+        if (options.pipe_stdin) {
+            posix_spawn_file_actions_adddup2(&actions, pipes[0][0], STDIN_FILENO);
+        }
+        if (options.capture_output) {
+            posix_spawn_file_actions_adddup2(&actions, pipes[1][1], STDOUT_FILENO);
+            posix_spawn_file_actions_adddup2(&actions, pipes[2][1], STDERR_FILENO);
+        }
+
+        pid_t      pid = -1;
+        const auto spawn_error =
+          posix_spawnp(&pid, argv.front(), &actions, nullptr, argv.data(), environ);
+        posix_spawn_file_actions_destroy(&actions);
+
+        if (spawn_error != 0) {
+            close_pipes();
+            return std::unexpected(ProcessError(
+              ProcessError::ErrorType::SpawnFailed,
+              arguments.front() + ": " + std::strerror(spawn_error)
+            ));
+        }
+
+        // Keep only the parent's ends: the write end of stdin and the read
+        // ends of stdout and stderr
+        process.m_pid    = pid;
+        process.m_stdin  = std::exchange(pipes[0][1], -1);
+        process.m_stdout = std::exchange(pipes[1][0], -1);
+        process.m_stderr = std::exchange(pipes[2][0], -1);
+        close_pipes();
+
+        return process;
     }
 
-    [[nodiscard]] auto argc() const noexcept -> std::size_t {
-        return m_command.size();
+    Process(const Process&)                    = delete;
+    auto operator=(const Process&) -> Process& = delete;
+
+    Process(Process&& other) noexcept
+      : m_options{ other.m_options },
+        m_started{ other.m_started },
+        m_pid{ std::exchange(other.m_pid, -1) },
+        m_stdin{ std::exchange(other.m_stdin, -1) },
+        m_stdout{ std::exchange(other.m_stdout, -1) },
+        m_stderr{ std::exchange(other.m_stderr, -1) } {}
+
+    auto operator=(Process&& other) noexcept -> Process& = delete;
+
+    // Reaps a child nobody waited for, so it does not linger as a zombie
+    ~Process() noexcept {
+        if (m_pid > 0) { static_cast<void>(wait()); }
     }
 
-  private:
-    explicit ShellCommand(const std::string& command) {
-        const std::size_t argc = std::ranges::count(command, ' ');
-        m_command.reserve(argc + 1);
+    [[nodiscard]] auto pid() const noexcept -> int { return m_pid; }
 
-        for (const auto& word : std::views::split(command, ' ')) {
-            m_command.emplace_back(std::string_view{word});
+    // Writes all of `data` to the child's stdin, requires pipe_stdin
+    [[nodiscard]] auto write(std::string_view data) noexcept
+      -> std::expected<void, ProcessError> {
+        while (!data.empty()) {
+            const auto written = ::write(m_stdin, data.data(), data.size());
+            if (written < 0) {
+                if (errno == EINTR) { continue; }
+                return std::unexpected(ProcessError(
+                  ProcessError::ErrorType::WriteFailed, std::strerror(errno)
+                ));
+            }
+            data.remove_prefix(static_cast<std::size_t>(written));
         }
+
+        return {};
     }
 
-    std::vector<std::string> m_command;
-};
+    // Closes the child's stdin, drains its output and reaps it. A child
+    // still running when the timeout expires is killed.
+    [[nodiscard]] auto wait() noexcept -> std::expected<ProcessResult, ProcessError> {
+        close_fd(m_stdin);
 
-#if defined(__unix__) || (defined(__APPLE__) && defined(__MACH__))
-[[nodiscard]] auto run_posix(const ShellCommand& command) noexcept
-  -> std::expected<int, ProcessError> {
-    const auto child_pid = fork();
-    if (child_pid < 0) {
-        return std::unexpected(ProcessError(
-          ProcessError::ErrorType::ForkFailed, std::strerror(errno)
-        ));
-    }
+        ProcessResult result;
+        result.pid = m_pid;
 
-    if (child_pid == 0) {
-        // Split a string into a vector of strings  on whitespace
-        const auto&        raw_command = command.command();
-        std::vector<char*> argv;
-        for (const auto& piece : raw_command) {
-            argv.push_back(const_cast<char*>(piece.data()));
+        int  status = 0;
+        bool exited = false;
+        while (!exited) {
+            const auto remaining = remaining_time();
+            if (remaining && *remaining <= std::chrono::milliseconds::zero()) {
+                kill(m_pid, SIGKILL);
+                result.timed_out = true;
+                break;
+            }
+
+            if (m_stdout >= 0 || m_stderr >= 0) {
+                // Output pipes reach EOF once the child exits, so reading
+                // them until then is all the waiting that is needed
+                if (!drain_output(result, remaining)) {
+                    const auto error = errno;
+                    kill(m_pid, SIGKILL);
+                    static_cast<void>(reap(status));
+                    m_pid = -1;
+                    return std::unexpected(ProcessError(
+                      ProcessError::ErrorType::ReadFailed, std::strerror(error)
+                    ));
+                }
+                continue;
+            }
+
+            if (!remaining) { break; }
+
+            const auto reaped = waitpid(m_pid, &status, WNOHANG);
+            if (reaped < 0 && errno != EINTR) { break; }
+            if (reaped == m_pid) {
+                exited = true;
+                break;
+            }
+
+            poll(nullptr, 0, static_cast<int>(std::min(*remaining, poll_interval).count()));
         }
-        argv.push_back(nullptr);
 
+        close_fd(m_stdout);
+        close_fd(m_stderr);
 
-        const auto return_code =
-          execvp(command.program_name().data(), argv.data());
+        if (!exited && !reap(status)) {
+            m_pid = -1;
+            return std::unexpected(ProcessError(
+              ProcessError::ErrorType::WaitFailed, std::strerror(errno)
+            ));
+        }
+        m_pid = -1;
 
-        if (return_code == -1) { return return_code; }
+        result.exit_code = WIFEXITED(status) ? WEXITSTATUS(status)
+                                             : 128 + WTERMSIG(status);
+        return result;
     }
 
-    return 0;
-}
+  private:
+    static constexpr std::chrono::milliseconds poll_interval{ 10 };
+
+    explicit Process(const ProcessOptions& options) noexcept
+      : m_options{ options },
+        m_started{ std::chrono::steady_clock::now() } {}
+
+    // Both ends are close-on-exec, so children spawned concurrently never
+    // inherit each other's pipes and keep them from reaching EOF. pipe2 sets
+    // the flag atomically, elsewhere spawn() serializes on spawn_mutex() so
+    // no child is spawned between pipe() and fcntl()
+    [[nodiscard]] static auto make_pipe(std::array<int, 2>& ends) noexcept -> bool {
+#ifdef DTSUTIL_HAS_PIPE2
+        return pipe2(ends.data(), O_CLOEXEC) == 0;
 #else
-[[nodiscard]] auto run_windows(const ShellCommand& command) noexcept
-  -> std::expected<int, ProcessError> {}
+        if (pipe(ends.data()) != 0) { return false; }
+        for (const auto fd : ends) { fcntl(fd, F_SETFD, FD_CLOEXEC); }
+        return true;
 #endif
+    }
 
-[[nodiscard]] auto run(const ShellCommand& command) noexcept
-  -> std::expected<int, ProcessError> {
-#if defined(__unix__) || (defined(__APPLE__) && defined(__MACH__))
-    return run_posix(command);
-#else
-    return run_windows(command);
+#ifndef DTSUTIL_HAS_PIPE2
+    [[nodiscard]] static auto spawn_mutex() noexcept -> std::mutex& {
+        static std::mutex mutex;
+        return mutex;
+    }
 #endif
-}
 
-} // namespace detail
+    static auto close_fd(int& fd) noexcept -> void {
+        if (fd >= 0) { close(fd); }
+        fd = -1;
+    }
+
+    [[nodiscard]] auto remaining_time() const noexcept
+      -> std::optional<std::chrono::milliseconds> {
+        if (!m_options.timeout) { return std::nullopt; }
+        return *m_options.timeout -
+               std::chrono::duration_cast<std::chrono::milliseconds>(
+                 std::chrono::steady_clock::now() - m_started
+               );
+    }
+
+    // Blocks until some output arrives or the timeout expires and appends
+    // what is available, closing each pipe on EOF
+    [[nodiscard]] auto drain_output(
+      ProcessResult& result, std::optional<std::chrono::milliseconds> remaining
+    ) noexcept -> bool {
+        std::array<pollfd, 2> fds{
+            { { m_stdout, POLLIN, 0 }, { m_stderr, POLLIN, 0 } }
+        };
+        const auto timeout = remaining ? static_cast<int>(remaining->count()) : -1;
+        if (poll(fds.data(), fds.size(), timeout) < 0) { return errno == EINTR; }
+
+        const std::array<std::pair<int*, std::string*>, 2> streams{
+            { { &m_stdout, &result.stdout_output },
+              { &m_stderr, &result.stderr_output } }
+        };
+        for (std::size_t stream = 0; stream < streams.size(); ++stream) {
+            if (fds[stream].fd < 0 || fds[stream].revents == 0) { continue; }
+
+            std::array<char, 4096> buffer;
+            const auto read_bytes = read(fds[stream].fd, buffer.data(), buffer.size());
+            if (read_bytes < 0) {
+                if (errno == EINTR || errno == EAGAIN) { continue; }
+                return false;
+            }
+            if (read_bytes == 0) {
+                close_fd(*streams[stream].first);
+                continue;
+            }
+            streams[stream].second->append(buffer.data(), static_cast<std::size_t>(read_bytes));
+        }
+
+        return true;
+    }
 
-[[nodiscard]] auto subprocess_run(const std::string& command) noexcept
-  -> std::expected<int, ProcessError> {
-    if (command.empty()) {
-        return std::unexpected(
-          ProcessError(ProcessError::ErrorType::EmptyCommand, {})
-        );
+    [[nodiscard]] auto reap(int& status) const noexcept -> bool {
+        while (waitpid(m_pid, &status, 0) < 0) {
+            if (errno != EINTR) { return false; }
+        }
+        return true;
     }
-    return detail::run(detail::ShellCommand::create(command));
+
+    ProcessOptions                        m_options;
+    std::chrono::steady_clock::time_point m_started;
+    int                                   m_pid    = -1;
+    int                                   m_stdin  = -1;
+    int                                   m_stdout = -1;
+    int                                   m_stderr = -1;
 };
 
+// Spawns `arguments` and waits for it to finish
+[[nodiscard]] inline auto
+subprocess_run(const std::vector<std::string>& arguments, const ProcessOptions& options = {}) noexcept
+  -> std::expected<ProcessResult, ProcessError> {
+    auto process = Process::spawn(arguments, options);
+    if (!process) { return std::unexpected(process.error()); }
+    return process->wait();
+}
+
+#endif // DTSUTIL_HAS_POSIX_SPAWN
+
 } // namespace dts
 
 #endif //DTSUTIL_PROCESS_HPP
@@ -0,0 +1,36 @@
+#include "Arena.hpp"
+
+#include <algorithm>
+#include <cstdint>
+
+Arena::~Arena() noexcept
+{
+    // Reverse creation order, nodes never touch the nodes they point to
+    // while being destroyed so the order is not otherwise significant
+    for (auto* record = m_destructors; record != nullptr; record = record->previous) {
+        record->destroy(record->object);
+    }
+}
+
+void* Arena::allocate(const std::size_t size, const std::size_t alignment)
+{
+    const auto aligned = [alignment](std::byte* pointer) {
+        const auto address = reinterpret_cast<std::uintptr_t>(pointer);
+        return reinterpret_cast<std::byte*>((address + alignment - 1) & ~(alignment - 1));
+    };
+
+    auto* start = aligned(m_cursor);
+    if (m_cursor == nullptr || start + size > m_end) {
+        // Oversized requests get a block of their own
+        const auto new_block_size = std::max(block_size, size + alignment);
+        m_blocks.push_back(std::make_unique_for_overwrite<std::byte[]>(new_block_size));
+
+        m_cursor = m_blocks.back().get();
+        m_end    = m_cursor + new_block_size;
+        start    = aligned(m_cursor);
+    }
+
+    m_cursor = start + size;
+    m_bytes_allocated += size;
+    return start;
+}
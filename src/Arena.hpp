@@ -0,0 +1,74 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Bump allocator owning every AST node of a compilation. Nodes are placed
+// back to back in large blocks and handed out as stable raw pointers, they
+// are never freed individually: the whole tree goes away with the arena.
+class [[nodiscard]] Arena
+{
+  public:
+    Arena() noexcept = default;
+
+    ~Arena() noexcept;
+
+    Arena(const Arena&) = delete;
+
+    Arena(Arena&&) = delete;
+
+    Arena& operator=(const Arena&) = delete;
+
+    Arena& operator=(Arena&&) = delete;
+
+    template <typename T, typename... Args>
+    [[nodiscard]] T* create(Args&&... args)
+    {
+        ++m_objects_created;
+        if constexpr (std::is_trivially_destructible_v<T>) {
+            return ::new (allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+        } else {
+            // The destructor record is allocated first so a throwing
+            // constructor never leaves a record pointing at a dead object
+            auto* const record = static_cast<DestructorRecord*>(
+                allocate(sizeof(DestructorRecord), alignof(DestructorRecord)));
+            T* const object =
+                ::new (allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+
+            *record = DestructorRecord{
+                .object   = object,
+                .destroy  = [](void* pointer) noexcept { static_cast<T*>(pointer)->~T(); },
+                .previous = m_destructors,
+            };
+            m_destructors = record;
+            return object;
+        }
+    }
+
+    [[nodiscard]] std::size_t bytes_allocated() const noexcept { return m_bytes_allocated; }
+
+    [[nodiscard]] std::size_t objects_created() const noexcept { return m_objects_created; }
+
+  private:
+    struct DestructorRecord
+    {
+        void* object;
+        void (*destroy)(void*) noexcept;
+        DestructorRecord* previous;
+    };
+
+    static constexpr std::size_t block_size = 64 * 1024;
+
+    [[nodiscard]] void* allocate(std::size_t size, std::size_t alignment);
+
+    std::vector<std::unique_ptr<std::byte[]>> m_blocks;
+    std::byte*                                m_cursor          = nullptr;
+    std::byte*                                m_end             = nullptr;
+    DestructorRecord*                         m_destructors     = nullptr;
+    std::size_t                               m_bytes_allocated = 0;
+    std::size_t                               m_objects_created = 0;
+};
@@ -0,0 +1,265 @@
+#include "BuildCache.hpp"
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+#include <utility>
+#include <vector>
+
+#include <fmt/format.h>
+
+namespace
+{
+
+constexpr std::array<std::uint32_t, 64> round_constants = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2,
+};
+
+} // namespace
+
+void BuildCache::KeyBuilder::add(const std::string_view data) noexcept
+{
+    const auto length = static_cast<std::uint64_t>(data.size());
+    mix(std::string_view(reinterpret_cast<const char*>(&length), sizeof(length)));
+    mix(data);
+}
+
+std::string BuildCache::KeyBuilder::key() const
+{
+    // Padding is applied to a copy, so more data can still be added
+    auto       state = m_state;
+    auto       block = m_block;
+    auto       used  = static_cast<std::size_t>(m_length % block.size());
+    const auto bits  = m_length * 8;
+
+    block[used++] = 0x80;
+    if (used > block.size() - sizeof(bits)) {
+        std::fill(block.begin() + static_cast<std::ptrdiff_t>(used), block.end(), std::uint8_t{0});
+        compress(state, block);
+        used = 0;
+    }
+    std::fill(block.begin() + static_cast<std::ptrdiff_t>(used), block.end() - sizeof(bits), std::uint8_t{0});
+    for (std::size_t i = 0; i < sizeof(bits); ++i) {
+        block[block.size() - 1 - i] = static_cast<std::uint8_t>(bits >> (8 * i));
+    }
+    compress(state, block);
+
+    std::string key;
+    key.reserve(2 * sizeof(state));
+    for (const auto word : state) { fmt::format_to(std::back_inserter(key), "{:08x}", word); }
+    return key;
+}
+
+void BuildCache::KeyBuilder::mix(const std::string_view bytes) noexcept
+{
+    for (const auto byte : bytes) {
+        m_block[m_length % m_block.size()] = static_cast<std::uint8_t>(byte);
+        if (++m_length % m_block.size() == 0) { compress(m_state, m_block); }
+    }
+}
+
+void BuildCache::KeyBuilder::compress(State& state, const Block& block) noexcept
+{
+    std::array<std::uint32_t, 64> schedule{};
+    for (std::size_t i = 0; i < 16; ++i) {
+        schedule[i] = static_cast<std::uint32_t>(block[4 * i]) << 24 |
+                      static_cast<std::uint32_t>(block[4 * i + 1]) << 16 |
+                      static_cast<std::uint32_t>(block[4 * i + 2]) << 8 |
+                      static_cast<std::uint32_t>(block[4 * i + 3]);
+    }
+    for (std::size_t i = 16; i < schedule.size(); ++i) {
+        const auto s0 = std::rotr(schedule[i - 15], 7) ^ std::rotr(schedule[i - 15], 18) ^ (schedule[i - 15] >> 3);
+        const auto s1 = std::rotr(schedule[i - 2], 17) ^ std::rotr(schedule[i - 2], 19) ^ (schedule[i - 2] >> 10);
+        schedule[i]   = schedule[i - 16] + s0 + schedule[i - 7] + s1;
+    }
+
+    auto [a, b, c, d, e, f, g, h] = state;
+    for (std::size_t i = 0; i < schedule.size(); ++i) {
+        const auto s1     = std::rotr(e, 6) ^ std::rotr(e, 11) ^ std::rotr(e, 25);
+        const auto choice = (e & f) ^ (~e & g);
+        const auto t1     = h + s1 + choice + round_constants[i] + schedule[i];
+        const auto s0     = std::rotr(a, 2) ^ std::rotr(a, 13) ^ std::rotr(a, 22);
+        const auto major  = (a & b) ^ (a & c) ^ (b & c);
+        const auto t2     = s0 + major;
+
+        h = g;
+        g = f;
+        f = e;
+        e = d + t1;
+        d = c;
+        c = b;
+        b = a;
+        a = t1 + t2;
+    }
+
+    const std::array<std::uint32_t, 8> working{a, b, c, d, e, f, g, h};
+    for (std::size_t i = 0; i < state.size(); ++i) { state[i] += working[i]; }
+}
+
+BuildCache::BuildCache(std::filesystem::path directory, const std::uintmax_t max_size) noexcept
+    : m_directory{std::move(directory)},
+      m_max_size{max_size}
+{
+}
+
+std::optional<BuildCache> BuildCache::open(std::filesystem::path directory, const std::uintmax_t max_size) noexcept
+{
+    if (directory.empty()) { return std::nullopt; }
+
+    std::error_code error;
+    std::filesystem::create_directories(directory, error);
+    if (error || !std::filesystem::is_directory(directory, error)) { return std::nullopt; }
+
+    return BuildCache(std::move(directory), max_size);
+}
+
+std::filesystem::path BuildCache::default_directory() noexcept
+{
+    if (const auto* xdg_cache_home = std::getenv("XDG_CACHE_HOME");
+        xdg_cache_home != nullptr && *xdg_cache_home != '\0') {
+        return std::filesystem::path(xdg_cache_home) / "dl";
+    }
+
+    if (const auto* home = std::getenv("HOME"); home != nullptr && *home != '\0') {
+        return std::filesystem::path(home) / ".cache" / "dl";
+    }
+
+    return {};
+}
+
+std::string BuildCache::file_identity(const std::filesystem::path& file)
+{
+    std::error_code error;
+    const auto      size          = std::filesystem::file_size(file, error);
+    const auto      last_modified = std::filesystem::last_write_time(file, error);
+    if (error) { return {}; }
+
+    return fmt::format("{}:{}:{}", file.string(), size, last_modified.time_since_epoch().count());
+}
+
+std::optional<std::string> BuildCache::compiler_version(const std::string_view compiler_identity) const
+{
+    std::ifstream file(compiler_version_path(compiler_identity), std::ios::binary);
+    if (!file) { return std::nullopt; }
+
+    std::string version(std::istreambuf_iterator<char>(file), {});
+    if (version.empty()) { return std::nullopt; }
+    return version;
+}
+
+void BuildCache::store_compiler_version(
+    const std::string_view compiler_identity, const std::string_view version) const noexcept
+{
+    const auto entry = compiler_version_path(compiler_identity);
+
+    std::error_code error;
+    std::filesystem::create_directories(entry.parent_path(), error);
+    if (error) { return; }
+
+    const auto temporary = fmt::format("{}.{}.tmp", entry.string(), getpid());
+    {
+        std::ofstream file(temporary, std::ios::binary);
+        file.write(version.data(), static_cast<std::streamsize>(version.size()));
+        if (!file.flush()) {
+            std::filesystem::remove(temporary, error);
+            return;
+        }
+    }
+    publish(temporary, entry);
+}
+
+std::filesystem::path BuildCache::compiler_version_path(const std::string_view compiler_identity) const
+{
+    KeyBuilder key_builder;
+    key_builder.add(compiler_identity);
+    return m_directory / "compilers" / key_builder.key();
+}
+
+void BuildCache::publish(const std::filesystem::path& source, const std::filesystem::path& entry) noexcept
+{
+    std::error_code error;
+    std::filesystem::rename(source, entry, error);
+    if (error) { std::filesystem::remove(source, error); }
+}
+
+bool BuildCache::restore(const std::string& key, const std::filesystem::path& output) const noexcept
+{
+    const auto entry = m_directory / key;
+
+    std::error_code error;
+    if (!std::filesystem::is_regular_file(entry, error)) { return false; }
+    std::filesystem::last_write_time(entry, std::filesystem::file_time_type::clock::now(), error);
+
+    // Linkers replace their output instead of writing through it, so sharing
+    // the inode with the cache entry is safe. Across filesystems, copy.
+    std::filesystem::remove(output, error);
+    std::filesystem::create_hard_link(entry, output, error);
+    if (!error) { return true; }
+
+    return std::filesystem::copy_file(
+        entry, output, std::filesystem::copy_options::overwrite_existing, error);
+}
+
+void BuildCache::store(const std::string& key, const std::filesystem::path& output) const noexcept
+{
+    // Copy under a private name and publish it once complete
+    const auto temporary = m_directory / fmt::format("{}.{}.tmp", key, getpid());
+
+    std::error_code error;
+    if (!std::filesystem::copy_file(
+            output, temporary, std::filesystem::copy_options::overwrite_existing, error)) {
+        std::filesystem::remove(temporary, error);
+        return;
+    }
+
+    publish(temporary, m_directory / key);
+    prune();
+}
+
+void BuildCache::prune() const noexcept
+{
+    struct Entry
+    {
+        std::filesystem::path           path;
+        std::uintmax_t                  size;
+        std::filesystem::file_time_type last_used;
+    };
+
+    // Only binaries count, the compilers/ directory and the copies still
+    // being written by other builds are left alone
+    std::vector<Entry> entries;
+    std::uintmax_t     total_size = 0;
+
+    std::error_code error;
+    for (std::filesystem::directory_iterator it(m_directory, error), end; !error && it != end;
+         it.increment(error)) {
+        std::error_code entry_error;
+        if (!it->is_regular_file(entry_error) || it->path().extension() == ".tmp") { continue; }
+
+        const auto size      = it->file_size(entry_error);
+        const auto last_used = it->last_write_time(entry_error);
+        if (entry_error) { continue; }
+
+        entries.push_back(Entry{.path = it->path(), .size = size, .last_used = last_used});
+        total_size += size;
+    }
+    if (total_size <= m_max_size) { return; }
+
+    std::ranges::sort(entries, {}, &Entry::last_used);
+    for (const auto& entry : entries) {
+        if (total_size <= m_max_size) { break; }
+        if (std::filesystem::remove(entry.path, error)) { total_size -= entry.size; }
+    }
+}
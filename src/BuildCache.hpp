@@ -0,0 +1,84 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <string_view>
+
+// Content-addressed store of compiled binaries. A binary is filed under a key
+// hashed from everything that went into producing it, so a later build with
+// the same inputs can take it from the cache instead of invoking the compiler.
+// Once the binaries outgrow the maximum size, the least recently used ones
+// are removed.
+class [[nodiscard]] BuildCache
+{
+  public:
+    // Accumulates the inputs of a build into a cache key. Every piece is
+    // length-prefixed, so moving bytes between pieces changes the key.
+    class [[nodiscard]] KeyBuilder
+    {
+      public:
+        void add(std::string_view data) noexcept;
+
+        [[nodiscard]] std::string key() const;
+
+      private:
+        // SHA-256, so distinct builds cannot share an entry by accident
+        using State = std::array<std::uint32_t, 8>;
+        using Block = std::array<std::uint8_t, 64>;
+
+        static void compress(State& state, const Block& block) noexcept;
+
+        void mix(std::string_view bytes) noexcept;
+
+        State         m_state{0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
+                              0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19};
+        Block         m_block{};
+        std::uint64_t m_length = 0;
+    };
+
+    static constexpr std::uintmax_t default_max_size = std::uintmax_t{512} << 20;
+
+    // Creates the cache directory if needed, empty if it cannot be used
+    [[nodiscard]] static std::optional<BuildCache>
+    open(std::filesystem::path directory, std::uintmax_t max_size = default_max_size) noexcept;
+
+    // $XDG_CACHE_HOME/dl, falling back to $HOME/.cache/dl
+    [[nodiscard]] static std::filesystem::path default_directory() noexcept;
+
+    // Path, size and modification time of `file`, which change whenever the
+    // file is rebuilt or replaced. Empty if the file cannot be examined.
+    [[nodiscard]] static std::string file_identity(const std::filesystem::path& file);
+
+    // The compiler release recorded for the compiler binary with the given
+    // file_identity(), so the compiler is only asked once per binary
+    [[nodiscard]] std::optional<std::string> compiler_version(std::string_view compiler_identity) const;
+
+    void store_compiler_version(std::string_view compiler_identity, std::string_view version) const noexcept;
+
+    // Places the binary cached under `key` at `output`, hard-linking it when
+    // possible, and marks it as just used. Returns false on a miss.
+    [[nodiscard]] bool restore(const std::string& key, const std::filesystem::path& output) const noexcept;
+
+    // Files a copy of `output` under `key`, then evicts the least recently
+    // used binaries beyond the maximum size. Failing to do so only costs a
+    // future cache hit, so errors are ignored.
+    void store(const std::string& key, const std::filesystem::path& output) const noexcept;
+
+  private:
+    BuildCache(std::filesystem::path directory, std::uintmax_t max_size) noexcept;
+
+    // Binaries are marked as used through their modification time
+    void prune() const noexcept;
+
+    [[nodiscard]] std::filesystem::path compiler_version_path(std::string_view compiler_identity) const;
+
+    // Moves `source` to `entry` in one step, so concurrent builds never see
+    // a half-written file
+    static void publish(const std::filesystem::path& source, const std::filesystem::path& entry) noexcept;
+
+    std::filesystem::path m_directory;
+    std::uintmax_t        m_max_size;
+};
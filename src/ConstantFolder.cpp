@@ -0,0 +1,604 @@
+#include "ConstantFolder.hpp"
+
+#include <charconv>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <fmt/format.h>
+
+#include "Arena.hpp"
+#include "Expression.hpp"
+#include "Statement.hpp"
+
+namespace
+{
+
+using ExpressionType = Typechecker::ExpressionType;
+using BuiltinType    = Typechecker::BuiltinType;
+using Category       = ExpressionType::Category;
+
+// A value known at compile time. Integers are kept as their bit pattern,
+// sign or zero extended from the width of their type to 64 bits, so values
+// of every width compare and convert the same way.
+struct [[nodiscard]] Constant
+{
+    ExpressionType type;
+    std::uint64_t  bits;
+};
+
+[[nodiscard]] bool is_foldable(const ExpressionType& type) noexcept
+{
+    if (type.is_pointer()) { return false; }
+    if (type.category == Category::BOOLEAN) { return true; }
+    return type.category == Category::BUILTIN && type.builtin_type != BuiltinType::NONE &&
+           !Typechecker::is_floating_builtin_type(type.builtin_type);
+}
+
+[[nodiscard]] bool is_signed(const ExpressionType& type) noexcept
+{
+    return type.category == Category::BUILTIN &&
+           !Typechecker::is_unsigned_builtin_type(type.builtin_type);
+}
+
+// Converts `bits` to `type` the way C converts integers: modulo 2^width,
+// which gcc also uses for the implementation defined narrowing to signed
+[[nodiscard]] std::uint64_t convert(std::uint64_t bits, const ExpressionType& type) noexcept
+{
+    if (type.category == Category::BOOLEAN) { return bits != 0 ? 1 : 0; }
+
+    const auto width = Typechecker::builtin_type_width(type.builtin_type);
+    if (width == 64) { return bits; }
+
+    const auto mask = (std::uint64_t{1} << width) - 1;
+    bits &= mask;
+    if (is_signed(type) && (bits >> (width - 1)) != 0) { bits |= ~mask; }
+    return bits;
+}
+
+[[nodiscard]] Constant boolean(const bool value) noexcept
+{
+    return {.type = ExpressionType::boolean(), .bits = value ? 1U : 0U};
+}
+
+// Operations are evaluated in the type C promotes their operands to
+[[nodiscard]] ExpressionType promoted(const Constant& lhs, const Constant& rhs) noexcept
+{
+    return Typechecker::common_type(lhs.type, rhs.type);
+}
+
+[[nodiscard]] std::optional<Constant> negate(const Constant& operand) noexcept
+{
+    const auto type = promoted(operand, operand);
+    const auto bits = convert(operand.bits, type);
+
+    // Negating the minimum of a signed type overflows
+    const auto minimum = ~std::uint64_t{0} << (Typechecker::builtin_type_width(type.builtin_type) - 1);
+    if (is_signed(type) && bits == minimum) { return std::nullopt; }
+
+    return Constant{.type = type, .bits = convert(0 - bits, type)};
+}
+
+[[nodiscard]] std::optional<Constant>
+arithmetic(const Token::Type operator_type, const Constant& lhs, const Constant& rhs) noexcept
+{
+    const auto type  = promoted(lhs, rhs);
+    const auto left  = convert(lhs.bits, type);
+    const auto right = convert(rhs.bits, type);
+
+    if (operator_type == Token::Type::SLASH && right == 0) { return std::nullopt; }
+
+    if (!is_signed(type)) {
+        std::uint64_t result = 0;
+        switch (operator_type) {
+            case Token::Type::PLUS: {
+                result = left + right;
+                break;
+            }
+            case Token::Type::MINUS: {
+                result = left - right;
+                break;
+            }
+            case Token::Type::STAR: {
+                result = left * right;
+                break;
+            }
+            default: {
+                result = left / right;
+                break;
+            }
+        }
+        return Constant{.type = type, .bits = convert(result, type)};
+    }
+
+    const auto signed_left  = static_cast<std::int64_t>(left);
+    const auto signed_right = static_cast<std::int64_t>(right);
+
+    std::int64_t result   = 0;
+    bool         overflow = false;
+    switch (operator_type) {
+        case Token::Type::PLUS: {
+            overflow = __builtin_add_overflow(signed_left, signed_right, &result);
+            break;
+        }
+        case Token::Type::MINUS: {
+            overflow = __builtin_sub_overflow(signed_left, signed_right, &result);
+            break;
+        }
+        case Token::Type::STAR: {
+            overflow = __builtin_mul_overflow(signed_left, signed_right, &result);
+            break;
+        }
+        default: {
+            overflow = signed_left == std::numeric_limits<std::int64_t>::min() && signed_right == -1;
+            result   = overflow ? 0 : signed_left / signed_right;
+            break;
+        }
+    }
+
+    // Overflowing the operation's own width is as undefined as overflowing 64 bits
+    const auto bits = static_cast<std::uint64_t>(result);
+    if (overflow || convert(bits, type) != bits) { return std::nullopt; }
+    return Constant{.type = type, .bits = bits};
+}
+
+[[nodiscard]] Constant
+comparison(const Token::Type operator_type, const Constant& lhs, const Constant& rhs) noexcept
+{
+    const auto type  = promoted(lhs, rhs);
+    const auto left  = convert(lhs.bits, type);
+    const auto right = convert(rhs.bits, type);
+
+    const auto less = is_signed(type) ? static_cast<std::int64_t>(left) < static_cast<std::int64_t>(right)
+                                      : left < right;
+    switch (operator_type) {
+        case Token::Type::EQUAL_EQUAL: {
+            return boolean(left == right);
+        }
+        case Token::Type::BANG_EQUAL: {
+            return boolean(left != right);
+        }
+        case Token::Type::LESS: {
+            return boolean(less);
+        }
+        case Token::Type::LESS_EQUAL: {
+            return boolean(less || left == right);
+        }
+        case Token::Type::GREATER: {
+            return boolean(!less && left != right);
+        }
+        default: {
+            return boolean(!less);
+        }
+    }
+}
+
+[[nodiscard]] std::optional<Constant> literal_value(const LiteralExpression& literal) noexcept
+{
+    switch (literal.literal_type()) {
+        case Token::Type::TRUE: {
+            return boolean(true);
+        }
+        case Token::Type::FALSE: {
+            return boolean(false);
+        }
+        case Token::Type::NUMBER: {
+            break;
+        }
+        default: {
+            return std::nullopt;
+        }
+    }
+
+    // A leading zero makes the literal octal in C, those are left alone
+    const auto& text = literal.literal();
+    if (!is_foldable(literal.type()) || text.empty() || (text.size() > 1 && text.front() == '0')) {
+        return std::nullopt;
+    }
+
+    std::uint64_t value     = 0;
+    const auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), value);
+    if (error != std::errc{} || end != text.data() + text.size()) { return std::nullopt; }
+
+    return Constant{.type = literal.type(), .bits = convert(value, literal.type())};
+}
+
+// The literal C reads back as `constant`, with the suffix of its type.
+// Negative values are parenthesized so they never merge with an operator
+// emitted before them.
+[[nodiscard]] std::string literal_text(const Constant& constant) noexcept
+{
+    const auto builtin_type = constant.type.builtin_type;
+    const auto suffix       = [builtin_type] {
+        switch (builtin_type) {
+            case BuiltinType::U32: {
+                return "U";
+            }
+            case BuiltinType::U64: {
+                return "UL";
+            }
+            case BuiltinType::I64: {
+                return "L";
+            }
+            default: {
+                return "";
+            }
+        }
+    }();
+
+    if (!is_signed(constant.type)) { return fmt::format("{}{}", constant.bits, suffix); }
+
+    const auto value = static_cast<std::int64_t>(constant.bits);
+    if (value >= 0) { return fmt::format("{}{}", value, suffix); }
+
+    // The magnitude of the minimum does not fit its own type
+    const auto magnitude = std::uint64_t{0} - constant.bits;
+    const auto width     = Typechecker::builtin_type_width(builtin_type);
+    if (width >= 32 && magnitude == std::uint64_t{1} << (width - 1)) {
+        return fmt::format("(-{}{} - 1)", magnitude - 1, suffix);
+    }
+    return fmt::format("(-{}{})", magnitude, suffix);
+}
+
+class [[nodiscard]] Folder
+{
+  public:
+    explicit Folder(Arena& arena) noexcept
+        : m_arena{arena}
+    {
+    }
+
+    void fold(const std::span<ModuleStatement* const> modules)
+    {
+        for (const auto* modul : modules) {
+            for (auto* function : modul->functions().data()) {
+                fold_function(*function->as<FunctionStatement>());
+            }
+        }
+    }
+
+    [[nodiscard]] std::size_t folded() const noexcept { return m_folded; }
+
+  private:
+    // Constants are scoped like the variables they stand for, any other
+    // binding shadows them. The table is flat, as in Environment.
+    void enter_scope() { m_scope_marks.push_back(m_undo_log.size()); }
+
+    void exit_scope() noexcept
+    {
+        const auto mark = m_scope_marks.back();
+        m_scope_marks.pop_back();
+        while (m_undo_log.size() > mark) {
+            auto& bindings = m_bindings[m_undo_log.back()];
+            bindings.pop_back();
+            m_undo_log.pop_back();
+        }
+    }
+
+    void bind(const Symbol name, const std::optional<Constant> value)
+    {
+        m_bindings[name].push_back(value);
+        m_undo_log.push_back(name);
+    }
+
+    [[nodiscard]] std::optional<Constant> lookup(const Symbol name) const noexcept
+    {
+        const auto found = m_bindings.find(name);
+        if (found == m_bindings.end() || found->second.empty()) { return std::nullopt; }
+        return found->second.back();
+    }
+
+    // Statements
+
+    void fold_function(const FunctionStatement& function)
+    {
+        enter_scope();
+        for (const auto& arg : function.args()) { bind(arg.name, std::nullopt); }
+        fold_block(function.body());
+        exit_scope();
+    }
+
+    void fold_block(const BlockStatement& block)
+    {
+        enter_scope();
+        for (auto* statement : block.data()) { fold_statement(statement); }
+        exit_scope();
+    }
+
+    void fold_statement(Statement* statement)
+    {
+        if (statement == nullptr) { return; }
+        statement->visit([this](auto& node) { fold(node); });
+    }
+
+    void fold([[maybe_unused]] EmptyStatement& statement) {}
+
+    void fold([[maybe_unused]] ModuleStatement& statement) {}
+
+    void fold([[maybe_unused]] FunctionStatement& statement) {}
+
+    void fold([[maybe_unused]] StructStatement& statement) {}
+
+    void fold([[maybe_unused]] EnumStatement& statement) {}
+
+    void fold(BlockStatement& statement) { fold_block(statement); }
+
+    void fold(IfStatement& statement)
+    {
+        statement.set_condition(fold_operand(statement.condition()));
+        fold_block(statement.then_block());
+        fold_block(statement.else_block());
+    }
+
+    void fold(WhileStatement& statement)
+    {
+        statement.set_condition(fold_operand(statement.condition()));
+        fold_block(statement.body());
+    }
+
+    void fold(ForStatement& statement)
+    {
+        enter_scope();
+        fold_statement(statement.init_statement());
+        statement.set_condition(fold_operand(statement.condition()));
+        statement.set_increment_statement(fold_operand(statement.increment_statement()));
+        fold_block(statement.body());
+        exit_scope();
+    }
+
+    void fold(ReturnStatement& statement)
+    {
+        statement.set_expression(fold_operand(statement.expression()));
+    }
+
+    void fold(ExpressionStatement& statement)
+    {
+        statement.set_expression(fold_operand(statement.expression()));
+    }
+
+    void fold(VariableStatement& statement)
+    {
+        auto*      expression = statement.expression();
+        const auto value      = fold_expression(expression);
+        statement.set_expression(settle(expression, value));
+
+        // The declaration itself stays, its address may still be taken
+        const auto& declaration = statement.variable_declaration();
+        const auto  type        = Typechecker::declared_type(declaration);
+        if (declaration.is_mutable || !value || !is_foldable(type)) {
+            bind(declaration.name, std::nullopt);
+            return;
+        }
+
+        bind(declaration.name, Constant{.type = type, .bits = convert(value->bits, type)});
+    }
+
+    void fold(ArrayStatement& statement)
+    {
+        for (std::size_t i = 0; i < statement.elements().size(); ++i) {
+            statement.set_element(i, fold_operand(statement.elements()[i]));
+        }
+        bind(statement.variable_declaration().name, std::nullopt);
+    }
+
+    void fold(MatchStatement& statement)
+    {
+        statement.set_expression(fold_operand(statement.expression()));
+
+        for (const auto& match_case : statement.cases()) {
+            enter_scope();
+            for (const auto& name : match_case.destructuring) {
+                bind(Symbol::intern(name), std::nullopt);
+            }
+            fold_block(match_case.body);
+            exit_scope();
+        }
+    }
+
+    // Expressions
+
+    // Folds `expression` and returns what takes its place
+    [[nodiscard]] Expression* fold_operand(Expression* expression)
+    {
+        return settle(expression, fold_expression(expression));
+    }
+
+    // Replaces `expression` by the literal of `value` when it is known. Only
+    // the outermost constant node of a tree is replaced, the parents of
+    // constant operands that are constant themselves settle instead.
+    [[nodiscard]] Expression* settle(Expression* expression, const std::optional<Constant>& value)
+    {
+        if (!value || expression->kind() == Expression::Kind::LITERAL) { return expression; }
+
+        ++m_folded;
+        auto* literal = m_arena.create<LiteralExpression>(
+            value->type.category == Category::BOOLEAN
+                ? (value->bits != 0 ? Token::Type::TRUE : Token::Type::FALSE)
+                : Token::Type::NUMBER,
+            value->type.category == Category::BOOLEAN ? (value->bits != 0 ? "true" : "false")
+                                                      : literal_text(*value),
+            expression->position());
+        literal->set_type(value->type);
+        return literal;
+    }
+
+    // Objects that are written or have their address taken are never
+    // replaced, only what they contain is folded
+    void fold_lvalue(Expression* expression)
+    {
+        if (expression == nullptr || expression->kind() == Expression::Kind::VARIABLE) { return; }
+        if (auto* grouping = expression->as<GroupingExpression>()) {
+            fold_lvalue(grouping->expression());
+            return;
+        }
+        static_cast<void>(fold_expression(expression));
+    }
+
+    // Folds the operands of `expression` and returns its value when known,
+    // replacing `expression` is left to its parent
+    [[nodiscard]] std::optional<Constant> fold_expression(Expression* expression)
+    {
+        if (expression == nullptr) { return std::nullopt; }
+        return expression->visit([this](auto& node) { return evaluate(node); });
+    }
+
+    void fold_arguments(FunctionCallExpression& call)
+    {
+        for (std::size_t i = 0; i < call.arguments().size(); ++i) {
+            call.set_argument(i, fold_operand(call.arguments()[i]));
+        }
+    }
+
+    [[nodiscard]] std::optional<Constant> evaluate(LiteralExpression& expression) noexcept
+    {
+        return literal_value(expression);
+    }
+
+    [[nodiscard]] std::optional<Constant> evaluate(VariableExpression& expression) const noexcept
+    {
+        return lookup(expression.name());
+    }
+
+    [[nodiscard]] std::optional<Constant> evaluate(UnaryExpression& expression)
+    {
+        switch (expression.operator_type()) {
+            case Token::Type::AMPERSAND:
+            case Token::Type::PLUS_PLUS:
+            case Token::Type::MINUS_MINUS: {
+                fold_lvalue(expression.right());
+                return std::nullopt;
+            }
+            default: {
+                break;
+            }
+        }
+
+        const auto operand = fold_expression(expression.right());
+        if (operand) {
+            if (expression.operator_type() == Token::Type::BANG) { return boolean(operand->bits == 0); }
+            if (expression.operator_type() == Token::Type::MINUS) {
+                if (auto result = negate(*operand)) { return result; }
+            }
+        }
+
+        expression.set_right(settle(expression.right(), operand));
+        return std::nullopt;
+    }
+
+    [[nodiscard]] std::optional<Constant> evaluate(BinaryExpression& expression)
+    {
+        switch (expression.operator_type()) {
+            case Token::Type::DOT:
+            case Token::Type::ARROW:
+            case Token::Type::COLON_COLON: {
+                // The right side names a member, only call arguments fold
+                if (expression.operator_type() != Token::Type::COLON_COLON) {
+                    fold_lvalue(expression.left());
+                }
+                if (auto* call = expression.right()->as<FunctionCallExpression>()) {
+                    fold_arguments(*call);
+                }
+                return std::nullopt;
+            }
+            default: {
+                break;
+            }
+        }
+
+        const auto left  = fold_expression(expression.left());
+        const auto right = fold_expression(expression.right());
+        if (left && right) {
+            switch (expression.operator_type()) {
+                case Token::Type::PLUS:
+                case Token::Type::MINUS:
+                case Token::Type::STAR:
+                case Token::Type::SLASH: {
+                    if (auto result = arithmetic(expression.operator_type(), *left, *right)) {
+                        return result;
+                    }
+                    break;
+                }
+                default: {
+                    return comparison(expression.operator_type(), *left, *right);
+                }
+            }
+        }
+
+        expression.set_left(settle(expression.left(), left));
+        expression.set_right(settle(expression.right(), right));
+        return std::nullopt;
+    }
+
+    [[nodiscard]] std::optional<Constant> evaluate(LogicalExpression& expression)
+    {
+        const auto is_and = expression.operator_type() == Token::Type::AND;
+
+        // A left side deciding the result keeps the right side from being
+        // evaluated at all
+        const auto left = fold_expression(expression.left());
+        if (left && (left->bits != 0) != is_and) { return boolean(left->bits != 0); }
+
+        const auto right = fold_expression(expression.right());
+        if (left && right) { return boolean(right->bits != 0); }
+
+        expression.set_left(settle(expression.left(), left));
+        expression.set_right(settle(expression.right(), right));
+        return std::nullopt;
+    }
+
+    [[nodiscard]] std::optional<Constant> evaluate(GroupingExpression& expression)
+    {
+        const auto value = fold_expression(expression.expression());
+        if (value) { return value; }
+
+        expression.set_expression(settle(expression.expression(), value));
+        return std::nullopt;
+    }
+
+    [[nodiscard]] std::optional<Constant> evaluate(FunctionCallExpression& expression)
+    {
+        fold_lvalue(expression.function_name());
+        fold_arguments(expression);
+        return std::nullopt;
+    }
+
+    [[nodiscard]] std::optional<Constant> evaluate(IndexOperatorExpression& expression)
+    {
+        fold_lvalue(expression.variable_name());
+        expression.set_index(fold_operand(expression.index()));
+        return std::nullopt;
+    }
+
+    [[nodiscard]] std::optional<Constant> evaluate(AssignmentExpression& expression)
+    {
+        fold_lvalue(expression.lhs());
+        expression.set_rhs(fold_operand(expression.rhs()));
+        return std::nullopt;
+    }
+
+    [[nodiscard]] std::optional<Constant> evaluate(EnumExpression& expression)
+    {
+        if (auto* call = expression.enum_variant()->as<FunctionCallExpression>()) {
+            fold_arguments(*call);
+        }
+        return std::nullopt;
+    }
+
+    Arena&                                                           m_arena;
+    std::unordered_map<Symbol, std::vector<std::optional<Constant>>> m_bindings;
+    std::vector<Symbol>                                              m_undo_log;
+    std::vector<std::size_t>                                         m_scope_marks;
+    std::size_t                                                      m_folded = 0;
+};
+
+} // namespace
+
+std::size_t ConstantFolder::fold(const std::span<ModuleStatement* const> modules, Arena& arena)
+{
+    Folder folder(arena);
+    folder.fold(modules);
+    return folder.folded();
+}
@@ -0,0 +1,22 @@
+#pragma once
+
+#include <cstddef>
+#include <span>
+
+class Arena;
+class ModuleStatement;
+
+// Evaluates at dl compile time the operations whose operands are all known
+// and replaces them with their value, computed the way C computes it for the
+// types the typechecker resolved: operands are converted to their common
+// type and unsigned results wrap at its width. Immutable variables
+// initialized with a constant are replaced by their value where they are
+// read. Whatever C leaves undefined, signed overflow and division by zero, is
+// left in place for gcc to see.
+class [[nodiscard]] ConstantFolder
+{
+  public:
+    // Runs after the typechecker. The literals replacing folded nodes are
+    // allocated in `arena`, the number of nodes replaced is returned.
+    static std::size_t fold(std::span<ModuleStatement* const> modules, Arena& arena);
+};
@@ -0,0 +1,262 @@
+#include "DeadCodeEliminator.hpp"
+
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "Expression.hpp"
+#include "Statement.hpp"
+
+namespace
+{
+
+// Declarations are found by name alone, a name shared by several of them
+// reaches all of them
+class [[nodiscard]] Reachability
+{
+  public:
+    explicit Reachability(const std::span<ModuleStatement* const> modules)
+    {
+        for (const auto* modul : modules) {
+            for (const auto* statement : modul->structs().data()) {
+                declare(statement->as<StructStatement>()->name(), statement);
+            }
+            for (const auto* statement : modul->enums().data()) {
+                declare(statement->as<EnumStatement>()->name(), statement);
+            }
+            for (const auto* statement : modul->functions().data()) {
+                declare(statement->as<FunctionStatement>()->name(), statement);
+            }
+        }
+    }
+
+    [[nodiscard]] bool has_main() const noexcept
+    {
+        const auto main = Symbol::find("main");
+        return main && m_declarations.contains(*main);
+    }
+
+    // Walks everything `main` reaches, one declaration at a time
+    void run()
+    {
+        reach(Symbol::intern("main"));
+        while (!m_pending.empty()) {
+            const auto* statement = m_pending.back();
+            m_pending.pop_back();
+            walk_declaration(*statement);
+        }
+    }
+
+    [[nodiscard]] bool is_reached(const Statement& statement) const noexcept
+    {
+        return m_reached_statements.contains(&statement);
+    }
+
+  private:
+    void declare(const std::string_view name, const Statement* statement)
+    {
+        m_declarations[Symbol::intern(name)].push_back(statement);
+    }
+
+    // Names that are not declarations, variables and C functions above all,
+    // reach nothing
+    void reach(const Symbol name)
+    {
+        const auto found = m_declarations.find(name);
+        if (found == m_declarations.end() || !m_reached_names.insert(name).second) { return; }
+
+        for (const auto* statement : found->second) {
+            m_reached_statements.insert(statement);
+            m_pending.push_back(statement);
+        }
+    }
+
+    void reach(const Typechecker::Type& type)
+    {
+        const auto variant = type.variant();
+        if (const auto* custom_type = std::get_if<Typechecker::CustomType>(&variant)) {
+            reach(custom_type->name);
+        }
+    }
+
+    // Return types are kept as written, "Matrix*" for instance
+    void reach_return_type(std::string_view return_type)
+    {
+        while (!return_type.empty() && return_type.back() == '*') { return_type.remove_suffix(1); }
+        if (const auto name = Symbol::find(return_type)) { reach(*name); }
+    }
+
+    void walk_declaration(const Statement& statement)
+    {
+        if (const auto* function = statement.as<FunctionStatement>()) {
+            for (const auto& arg : function->args()) { reach(arg.type); }
+            reach_return_type(function->return_type());
+            walk_block(function->body());
+        } else if (const auto* struct_statement = statement.as<StructStatement>()) {
+            for (const auto& member : struct_statement->member_variables()) { reach(member.type); }
+        } else if (const auto* enum_statement = statement.as<EnumStatement>()) {
+            for (const auto& [variant, fields] : enum_statement->variants()) {
+                for (const auto& field : fields) { reach(field); }
+            }
+        }
+    }
+
+    // Statements
+
+    void walk_block(const BlockStatement& block)
+    {
+        for (const auto* statement : block.data()) { walk_statement(statement); }
+    }
+
+    void walk_statement(const Statement* statement)
+    {
+        if (statement == nullptr) { return; }
+        statement->visit([this](const auto& node) { walk(node); });
+    }
+
+    void walk([[maybe_unused]] const EmptyStatement& statement) {}
+
+    void walk([[maybe_unused]] const ModuleStatement& statement) {}
+
+    void walk([[maybe_unused]] const FunctionStatement& statement) {}
+
+    void walk([[maybe_unused]] const StructStatement& statement) {}
+
+    void walk([[maybe_unused]] const EnumStatement& statement) {}
+
+    void walk(const BlockStatement& statement) { walk_block(statement); }
+
+    void walk(const IfStatement& statement)
+    {
+        walk_expression(statement.condition());
+        walk_block(statement.then_block());
+        walk_block(statement.else_block());
+    }
+
+    void walk(const WhileStatement& statement)
+    {
+        walk_expression(statement.condition());
+        walk_block(statement.body());
+    }
+
+    void walk(const ForStatement& statement)
+    {
+        walk_statement(statement.init_statement());
+        walk_expression(statement.condition());
+        walk_expression(statement.increment_statement());
+        walk_block(statement.body());
+    }
+
+    void walk(const ReturnStatement& statement) { walk_expression(statement.expression()); }
+
+    void walk(const ExpressionStatement& statement) { walk_expression(statement.expression()); }
+
+    void walk(const VariableStatement& statement)
+    {
+        reach(statement.variable_declaration().type);
+        walk_expression(statement.expression());
+    }
+
+    void walk(const ArrayStatement& statement)
+    {
+        reach(statement.variable_declaration().type);
+        for (const auto* element : statement.elements()) { walk_expression(element); }
+    }
+
+    void walk(const MatchStatement& statement)
+    {
+        walk_expression(statement.expression());
+        for (const auto& match_case : statement.cases()) {
+            walk_expression(match_case.label);
+            walk_block(match_case.body);
+        }
+    }
+
+    // Expressions
+
+    void walk_expression(const Expression* expression)
+    {
+        if (expression == nullptr) { return; }
+        expression->visit([this](const auto& node) { walk(node); });
+    }
+
+    // Calls, function pointers and `Type::` accesses all name what they use
+    void walk(const VariableExpression& expression) { reach(expression.name()); }
+
+    void walk([[maybe_unused]] const LiteralExpression& expression) {}
+
+    void walk(const UnaryExpression& expression) { walk_expression(expression.right()); }
+
+    void walk(const BinaryExpression& expression)
+    {
+        walk_expression(expression.left());
+
+        // Fields are named on the right of an access, only method arguments
+        // can reach anything there
+        const auto is_access = expression.operator_type() == Token::Type::DOT ||
+                               expression.operator_type() == Token::Type::ARROW;
+        if (!is_access) {
+            walk_expression(expression.right());
+        } else if (const auto* call = expression.right()->as<FunctionCallExpression>()) {
+            for (const auto* argument : call->arguments()) { walk_expression(argument); }
+        }
+    }
+
+    void walk(const FunctionCallExpression& expression)
+    {
+        walk_expression(expression.function_name());
+        for (const auto* argument : expression.arguments()) { walk_expression(argument); }
+    }
+
+    void walk(const IndexOperatorExpression& expression)
+    {
+        walk_expression(expression.variable_name());
+        walk_expression(expression.index());
+    }
+
+    void walk(const AssignmentExpression& expression)
+    {
+        walk_expression(expression.lhs());
+        walk_expression(expression.rhs());
+    }
+
+    void walk(const LogicalExpression& expression)
+    {
+        walk_expression(expression.left());
+        walk_expression(expression.right());
+    }
+
+    void walk(const GroupingExpression& expression) { walk_expression(expression.expression()); }
+
+    void walk(const EnumExpression& expression)
+    {
+        walk_expression(expression.enum_base());
+
+        // The variant is named like a call, only its values can reach anything
+        if (const auto* call = expression.enum_variant()->as<FunctionCallExpression>()) {
+            for (const auto* argument : call->arguments()) { walk_expression(argument); }
+        }
+    }
+
+    std::unordered_map<Symbol, std::vector<const Statement*>> m_declarations;
+    std::unordered_set<Symbol>                                m_reached_names;
+    std::unordered_set<const Statement*>                      m_reached_statements;
+    std::vector<const Statement*>                             m_pending;
+};
+
+} // namespace
+
+std::size_t DeadCodeEliminator::eliminate(const std::span<ModuleStatement* const> modules)
+{
+    Reachability reachability(modules);
+    if (!reachability.has_main()) { return 0; }
+    reachability.run();
+
+    std::size_t eliminated = 0;
+    for (auto* modul : modules) {
+        eliminated += modul->retain(
+            [&reachability](const Statement& statement) { return reachability.is_reached(statement); });
+    }
+    return eliminated;
+}
@@ -0,0 +1,18 @@
+#pragma once
+
+#include <cstddef>
+#include <span>
+
+class ModuleStatement;
+
+// Drops the functions, structs and enums of every module that `main` can
+// never reach, so shared modules only cost what a program uses of them.
+// Declarations are reached by name: calls and any other mention of a
+// function, and every type spelled in a signature, a variable, a field or a
+// variant. A program without `main` is left whole.
+class [[nodiscard]] DeadCodeEliminator
+{
+  public:
+    // Returns the number of declarations dropped
+    static std::size_t eliminate(std::span<ModuleStatement* const> modules);
+};
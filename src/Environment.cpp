@@ -1,21 +1,40 @@
 #include "Environment.hpp"
 
-Environment::Environment(std::shared_ptr<Environment> parent) noexcept
-    : m_parent{std::move(parent)}
+void Environment::enter_scope() noexcept { m_scope_marks.push_back(m_undo_log.size()); }
+
+void Environment::exit_scope() noexcept
+{
+    if (m_scope_marks.empty()) { return; }
+
+    unwind_to(m_scope_marks.back());
+    m_scope_marks.pop_back();
+}
+
+void Environment::clear() noexcept
 {
+    unwind_to(0);
+    m_scope_marks.clear();
 }
 
 void Environment::enscope(const Typechecker::VariableDeclaration& variable) noexcept
 {
-    m_variables.push_back(variable);
+    m_bindings[variable.name].push_back(variable);
+    m_undo_log.push_back(variable.name);
+}
+
+const Typechecker::VariableDeclaration* Environment::find(const Symbol variable_name) const noexcept
+{
+    const auto found = m_bindings.find(variable_name);
+    if (found == m_bindings.end() || found->second.empty()) { return nullptr; }
+    return &found->second.back();
 }
 
-std::optional<Typechecker::VariableDeclaration>
-Environment::find(const std::string& variable_name) const noexcept
+void Environment::unwind_to(const std::size_t log_size) noexcept
 {
-    for (const auto& variable : m_variables) {
-        if (variable.name == variable_name) { return variable; }
+    // Emptied stacks stay in the map, so binding the same name again reuses
+    // their storage
+    while (m_undo_log.size() > log_size) {
+        m_bindings[m_undo_log.back()].pop_back();
+        m_undo_log.pop_back();
     }
-    if (m_parent != nullptr) { return m_parent->find(variable_name); }
-    return {};
 }
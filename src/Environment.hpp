@@ -1,25 +1,37 @@
 #pragma once
 
-#include <memory>
-#include <optional>
+#include <cstddef>
+#include <unordered_map>
 #include <vector>
 
+#include "Symbol.hpp"
 #include "Typechecker.hpp"
 
+// The variables in scope while parsing a function, kept flat: every name maps
+// to the stack of its bindings, innermost last, and an undo log remembers
+// which names each scope bound. Lookups are a single hash probe and once the
+// containers have grown, entering and leaving scopes allocates nothing, however
+// deeply blocks nest.
 class [[nodiscard]] Environment
 {
   public:
-    Environment() = default;
-    explicit Environment(std::shared_ptr<Environment> parent) noexcept;
+    void enter_scope() noexcept;
 
-    [[nodiscard]] std::shared_ptr<Environment> parent() const noexcept { return m_parent; }
+    // Drops every binding made since the matching enter_scope()
+    void exit_scope() noexcept;
+
+    // Drops every binding and scope, keeping the memory for the next function
+    void clear() noexcept;
 
     void enscope(const Typechecker::VariableDeclaration& variable) noexcept;
 
-    [[nodiscard]] std::optional<Typechecker::VariableDeclaration>
-    find(const std::string& variable_name) const noexcept;
+    // The innermost binding of `variable_name`, valid until its scope is left
+    [[nodiscard]] const Typechecker::VariableDeclaration* find(Symbol variable_name) const noexcept;
 
   private:
-    std::vector<Typechecker::VariableDeclaration> m_variables;
-    std::shared_ptr<Environment>                  m_parent = nullptr;
+    void unwind_to(std::size_t log_size) noexcept;
+
+    std::unordered_map<Symbol, std::vector<Typechecker::VariableDeclaration>> m_bindings;
+    std::vector<Symbol>                                                        m_undo_log;
+    std::vector<std::size_t>                                                   m_scope_marks;
 };
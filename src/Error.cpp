@@ -10,9 +10,3 @@ DLError::DLError(std::string message, const Position& position) noexcept
       m_position{position}
 {
 }
-
-DLError::DLError(std::string message, const size_t start, const size_t end) noexcept
-    : m_message{std::move(message)},
-      m_position{Position::create(start, end)}
-{
-}
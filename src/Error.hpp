@@ -23,8 +23,6 @@ class [[nodiscard]] DLError
   private:
     DLError(std::string message, const Position& position) noexcept;
 
-    DLError(std::string message, const size_t start, const size_t end) noexcept;
-
     std::string m_message;
     Position    m_position;
 };
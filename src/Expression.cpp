@@ -1,130 +1,163 @@
 #include "Expression.hpp"
 
-UnaryExpression::UnaryExpression(Token::Type unary_operator, std::shared_ptr<Expression> right) noexcept
-    : m_operator{unary_operator},
-      m_right{std::move(right)}
+#include <iterator>
+
+UnaryExpression::UnaryExpression(
+    Token::Type    unary_operator,
+    Expression*    right,
+    const Position position) noexcept
+    : Expression(static_kind, position),
+      m_operator{unary_operator},
+      m_right{right}
 {
 }
 
-std::string UnaryExpression::evaluate() const noexcept
+void UnaryExpression::emit(fmt::memory_buffer& out) const noexcept
 {
-    return fmt::format("{}{}", Token::type_to_string(m_operator), m_right->evaluate());
+    out.append(Token::type_to_string(m_operator));
+    m_right->emit(out);
 }
 
-VariableExpression::VariableExpression(std::string variable_name) noexcept
-    : m_variable_name{std::move(variable_name)}
+VariableExpression::VariableExpression(const Symbol variable_name, const Position position) noexcept
+    : Expression(static_kind, position),
+      m_variable_name{variable_name}
 {
 }
 
-std::string VariableExpression::evaluate() const noexcept
+void VariableExpression::emit(fmt::memory_buffer& out) const noexcept
 {
-    return m_variable_name;
+    out.append(m_variable_name.name());
 }
 
 BinaryExpression::BinaryExpression(
-    std::shared_ptr<Expression> left,
-    Token::Type                 binary_operator,
-    std::shared_ptr<Expression> right) noexcept
-    : m_left{std::move(left)},
+    Expression*    left,
+    Token::Type    binary_operator,
+    Expression*    right,
+    const Position position) noexcept
+    : Expression(static_kind, position),
+      m_left{left},
       m_operator{binary_operator},
-      m_right{std::move(right)}
+      m_right{right}
 {
 }
 
-std::string BinaryExpression::evaluate() const noexcept
+void BinaryExpression::emit(fmt::memory_buffer& out) const noexcept
 {
+    m_left->emit(out);
     switch (m_operator) {
         case Token::Type::COLON_COLON: {
-            return fmt::format("{}::{}", m_left->evaluate(), m_right->evaluate());
+            out.append(std::string_view("::"));
+            break;
         }
         case Token::Type::ARROW: {
-            return fmt::format("{}->{}", m_left->evaluate(), m_right->evaluate());
+            out.append(std::string_view("->"));
+            break;
         }
         case Token::Type::DOT: {
-            return fmt::format("{}.{}", m_left->evaluate(), m_right->evaluate());
+            out.append(std::string_view("."));
+            break;
         }
         default: {
-            return fmt::format(
-                "{} {} {}",
-                m_left->evaluate(),
-                Token::type_to_string(m_operator),
-                m_right->evaluate());
+            fmt::format_to(std::back_inserter(out), " {} ", Token::type_to_string(m_operator));
+            break;
         }
     }
+    m_right->emit(out);
 }
 
-LiteralExpression::LiteralExpression(std::string literal) noexcept
-    : m_literal{std::move(literal)}
+LiteralExpression::LiteralExpression(
+    const Token::Type literal_type,
+    std::string       literal,
+    const Position    position) noexcept
+    : Expression(static_kind, position),
+      m_literal_type{literal_type},
+      m_literal{std::move(literal)}
 {
 }
 
-std::string LiteralExpression::evaluate() const noexcept
+void LiteralExpression::emit(fmt::memory_buffer& out) const noexcept
 {
-    if (m_literal == "true") { return "1"; }
-    if (m_literal == "false") { return "0"; }
-    return m_literal;
+    if (m_literal == "true") {
+        out.push_back('1');
+    } else if (m_literal == "false") {
+        out.push_back('0');
+    } else {
+        out.append(m_literal);
+    }
 }
 
 FunctionCallExpression::FunctionCallExpression(
-    std::shared_ptr<Expression>              function_name,
-    std::vector<std::shared_ptr<Expression>> arguments) noexcept
-    : m_function_name{std::move(function_name)},
+    Expression*              function_name,
+    std::vector<Expression*> arguments,
+    const Position           position) noexcept
+    : Expression(static_kind, position),
+      m_function_name{function_name},
       m_arguments{std::move(arguments)}
 {
 }
 
-std::string FunctionCallExpression::evaluate() const noexcept
+void FunctionCallExpression::emit(fmt::memory_buffer& out) const noexcept
 {
-    std::string c_function_call_code = fmt::format("{}(", m_function_name->evaluate());
+    m_function_name->emit(out);
+    out.push_back('(');
     for (const auto& argument : m_arguments) {
-        c_function_call_code += argument->evaluate();
-        if (&argument != &m_arguments.back()) { c_function_call_code += ", "; }
+        argument->emit(out);
+        if (&argument != &m_arguments.back()) { out.append(std::string_view(", ")); }
     }
-    c_function_call_code += ")";
-    return c_function_call_code;
+    out.push_back(')');
 }
 IndexOperatorExpression::IndexOperatorExpression(
-    std::shared_ptr<Expression> variable_name,
-    std::shared_ptr<Expression> right) noexcept
-    : m_variable_name{std::move(variable_name)},
-      m_index{std::move(right)}
+    Expression*    variable_name,
+    Expression*    right,
+    const Position position) noexcept
+    : Expression(static_kind, position),
+      m_variable_name{variable_name},
+      m_index{right}
 {
 }
 
-std::string IndexOperatorExpression::evaluate() const noexcept
+void IndexOperatorExpression::emit(fmt::memory_buffer& out) const noexcept
 {
-    return fmt::format("{}[{}]", m_variable_name->evaluate(), m_index->evaluate());
+    m_variable_name->emit(out);
+    out.push_back('[');
+    m_index->emit(out);
+    out.push_back(']');
 }
 
 AssignmentExpression::AssignmentExpression(
-    std::shared_ptr<Expression> lhs,
-    Token::Type                 assignment_operator,
-    std::shared_ptr<Expression> rhs) noexcept
-    : m_lhs{std::move(lhs)},
+    Expression*    lhs,
+    Token::Type    assignment_operator,
+    Expression*    rhs,
+    const Position position) noexcept
+    : Expression(static_kind, position),
+      m_lhs{lhs},
       m_operator{assignment_operator},
-      m_rhs{std::move(rhs)}
+      m_rhs{rhs}
 {
 }
 
-std::string AssignmentExpression::evaluate() const noexcept
+void AssignmentExpression::emit(fmt::memory_buffer& out) const noexcept
 {
-    return fmt::format(
-        "{} {} {}", m_lhs->evaluate(), Token::type_to_string(m_operator), m_rhs->evaluate());
+    m_lhs->emit(out);
+    fmt::format_to(std::back_inserter(out), " {} ", Token::type_to_string(m_operator));
+    m_rhs->emit(out);
 }
 
 LogicalExpression::LogicalExpression(
-    std::shared_ptr<Expression> left,
-    Token::Type                 logical_operator,
-    std::shared_ptr<Expression> right) noexcept
-    : m_left{std::move(left)},
+    Expression*    left,
+    Token::Type    logical_operator,
+    Expression*    right,
+    const Position position) noexcept
+    : Expression(static_kind, position),
+      m_left{left},
       m_operator{logical_operator},
-      m_right{std::move(right)}
+      m_right{right}
 {
 }
 
-std::string LogicalExpression::evaluate() const noexcept
+void LogicalExpression::emit(fmt::memory_buffer& out) const noexcept
 {
-    const std::string logical_operator = [this] {
+    const std::string_view logical_operator = [this] {
         switch (m_operator) {
             case Token::Type::AND:
                 return "&&";
@@ -135,26 +168,45 @@ std::string LogicalExpression::evaluate() const noexcept
         }
     }();
 
-    return fmt::format("{} {} {}", m_left->evaluate(), logical_operator, m_right->evaluate());
+    m_left->emit(out);
+    fmt::format_to(std::back_inserter(out), " {} ", logical_operator);
+    m_right->emit(out);
+}
+
+GroupingExpression::GroupingExpression(Expression* expression, const Position position) noexcept
+    : Expression(static_kind, position),
+      m_expression{expression}
+{
 }
 
-GroupingExpression::GroupingExpression(std::shared_ptr<Expression> expression) noexcept
-    : m_expression{std::move(expression)}
+void GroupingExpression::emit(fmt::memory_buffer& out) const noexcept
 {
+    out.push_back('(');
+    m_expression->emit(out);
+    out.push_back(')');
 }
 
-std::string GroupingExpression::evaluate() const noexcept
+EnumExpression::EnumExpression(
+    Expression*    enum_base,
+    Expression*    enum_variant,
+    const Position position) noexcept
+    : Expression(static_kind, position),
+      m_enum_base{enum_base},
+      m_enum_variant{enum_variant}
 {
-    return fmt::format("({})", m_expression->evaluate());
 }
 
-EnumExpression::EnumExpression(std::shared_ptr<Expression> enum_base, std::shared_ptr<Expression> enum_variant) noexcept
-    : m_enum_base{std::move(enum_base)},
-      m_enum_variant{std::move(enum_variant)}
+void EnumExpression::emit(fmt::memory_buffer& out) const noexcept
 {
+    out.append(std::string_view("__dl_"));
+    m_enum_base->emit(out);
+    out.append(std::string_view("::"));
+    m_enum_variant->emit(out);
 }
 
-std::string EnumExpression::evaluate() const noexcept
+std::string Expression::evaluate() const noexcept
 {
-    return fmt::format("__dl_{}::{}", m_enum_base->evaluate(), m_enum_variant->evaluate());
+    fmt::memory_buffer out;
+    emit(out);
+    return fmt::to_string(out);
 }
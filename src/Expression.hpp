@@ -1,15 +1,37 @@
 #pragma once
 
-#include <memory>
+#include <cstdint>
 #include <string>
+#include <utility>
 #include <vector>
 
+#include "Position.hpp"
+#include "Symbol.hpp"
 #include "Token.hpp"
+#include "Typechecker.hpp"
 
 class [[nodiscard]] Expression
 {
   public:
-    Expression() = default;
+    enum class Kind : std::uint8_t
+    {
+        UNARY,
+        VARIABLE,
+        BINARY,
+        LITERAL,
+        FUNCTION_CALL,
+        INDEX_OPERATOR,
+        ASSIGNMENT,
+        LOGICAL,
+        GROUPING,
+        ENUM,
+    };
+
+    Expression(const Kind kind, const Position position) noexcept
+        : m_position{position},
+          m_kind{kind}
+    {
+    }
 
     virtual ~Expression() = default;
 
@@ -21,59 +43,105 @@ class [[nodiscard]] Expression
 
     Expression& operator=(Expression&& expression) = default;
 
-    [[nodiscard]] virtual std::string evaluate() const noexcept = 0;
+    // Appends the generated C++ for this node to `out`, the whole program is
+    // generated into one buffer instead of concatenating per-node strings
+    virtual void emit(fmt::memory_buffer& out) const noexcept = 0;
+
+    // The generated C++ for this node alone, for callers that need it as a
+    // standalone value rather than as part of the program
+    [[nodiscard]] std::string evaluate() const noexcept;
+
+    [[nodiscard]] constexpr Kind kind() const noexcept { return m_kind; }
+
+    // Where the node starts, or its operator for operations
+    [[nodiscard]] Position position() const noexcept { return m_position; }
 
+    // Set by the typechecker, unknown before it ran
+    [[nodiscard]] constexpr const Typechecker::ExpressionType& type() const noexcept
+    {
+        return m_type;
+    }
+
+    void set_type(const Typechecker::ExpressionType& type) noexcept { m_type = type; }
+
+    // Checked downcast driven by the node kind, RTTI is not required
     template <typename To>
     [[nodiscard]] To* as() noexcept
     {
-        return dynamic_cast<To*>(this);
+        return m_kind == To::static_kind ? static_cast<To*>(this) : nullptr;
+    }
+
+    template <typename To>
+    [[nodiscard]] const To* as() const noexcept
+    {
+        return m_kind == To::static_kind ? static_cast<const To*>(this) : nullptr;
     }
+
+    // Calls `visitor` with the node downcast to its concrete type
+    template <typename Visitor>
+    decltype(auto) visit(Visitor&& visitor);
+
+    template <typename Visitor>
+    decltype(auto) visit(Visitor&& visitor) const;
+
+  private:
+    Position                    m_position;
+    Typechecker::ExpressionType m_type;
+    Kind                        m_kind;
 };
 
 class [[nodiscard]] UnaryExpression final : public Expression
 {
   public:
-    UnaryExpression(Token::Type unary_operator, std::shared_ptr<Expression> right) noexcept;
+    static constexpr Kind static_kind = Kind::UNARY;
 
-    [[nodiscard]] std::string evaluate() const noexcept override;
+    UnaryExpression(Token::Type unary_operator, Expression* right, Position position) noexcept;
+
+    void emit(fmt::memory_buffer& out) const noexcept override;
 
     [[nodiscard]] Token::Type operator_type() const noexcept
     {
         return m_operator;
     };
 
+    [[nodiscard]] Expression* right() const noexcept { return m_right; }
+
+    void set_right(Expression* right) noexcept { m_right = right; }
+
   private:
-    Token::Type                 m_operator;
-    std::shared_ptr<Expression> m_right;
+    Token::Type m_operator;
+    Expression* m_right;
 };
 
 class [[nodiscard]] VariableExpression final : public Expression
 {
   public:
-    explicit VariableExpression(std::string variable_name) noexcept;
+    static constexpr Kind static_kind = Kind::VARIABLE;
 
-    [[nodiscard]] std::string evaluate() const noexcept override;
+    VariableExpression(Symbol variable_name, Position position) noexcept;
 
-    [[nodiscard]] constexpr std::string name() const noexcept
-    {
-        return m_variable_name;
-    }
+    void emit(fmt::memory_buffer& out) const noexcept override;
+
+    [[nodiscard]] constexpr Symbol name() const noexcept { return m_variable_name; }
 
   private:
-    std::string m_variable_name;
+    Symbol m_variable_name;
 };
 
 class [[nodiscard]] BinaryExpression final : public Expression
 {
   public:
+    static constexpr Kind static_kind = Kind::BINARY;
+
     BinaryExpression(
-        std::shared_ptr<Expression> left,
-        Token::Type                 binary_operator,
-        std::shared_ptr<Expression> right) noexcept;
+        Expression* left,
+        Token::Type binary_operator,
+        Expression* right,
+        Position    position) noexcept;
 
-    [[nodiscard]] std::string evaluate() const noexcept override;
+    void emit(fmt::memory_buffer& out) const noexcept override;
 
-    [[nodiscard]] std::shared_ptr<Expression> left() const noexcept
+    [[nodiscard]] Expression* left() const noexcept
     {
         return m_left;
     }
@@ -83,129 +151,269 @@ class [[nodiscard]] BinaryExpression final : public Expression
         return m_operator;
     };
 
-    [[nodiscard]] std::shared_ptr<Expression> right() const noexcept
+    [[nodiscard]] Expression* right() const noexcept
     {
         return m_right;
     }
 
+    void set_left(Expression* left) noexcept { m_left = left; }
+
+    void set_right(Expression* right) noexcept { m_right = right; }
+
   private:
-    std::shared_ptr<Expression> m_left;
-    Token::Type                 m_operator;
-    std::shared_ptr<Expression> m_right;
+    Expression* m_left;
+    Token::Type m_operator;
+    Expression* m_right;
 };
 
 class [[nodiscard]] LiteralExpression final : public Expression
 {
   public:
-    explicit LiteralExpression(std::string literal) noexcept;
+    static constexpr Kind static_kind = Kind::LITERAL;
+
+    LiteralExpression(Token::Type literal_type, std::string literal, Position position) noexcept;
+
+    void emit(fmt::memory_buffer& out) const noexcept override;
+
+    // NUMBER, TRUE, FALSE or one of the quoted strings
+    [[nodiscard]] Token::Type literal_type() const noexcept { return m_literal_type; }
 
-    [[nodiscard]] std::string evaluate() const noexcept override;
+    [[nodiscard]] const std::string& literal() const noexcept { return m_literal; }
 
   private:
+    Token::Type m_literal_type;
     std::string m_literal;
 };
 
 class [[nodiscard]] FunctionCallExpression final : public Expression
 {
   public:
+    static constexpr Kind static_kind = Kind::FUNCTION_CALL;
+
     FunctionCallExpression(
-        std::shared_ptr<Expression>              function_name,
-        std::vector<std::shared_ptr<Expression>> arguments) noexcept;
+        Expression*              function_name,
+        std::vector<Expression*> arguments,
+        Position                 position) noexcept;
 
-    [[nodiscard]] std::shared_ptr<Expression> function_name() const noexcept
+    [[nodiscard]] Expression* function_name() const noexcept
     {
         return m_function_name;
     }
 
-    [[nodiscard]] std::vector<std::shared_ptr<Expression>> arguments() const noexcept
+    [[nodiscard]] const std::vector<Expression*>& arguments() const noexcept
     {
         return m_arguments;
     }
 
-    [[nodiscard]] std::string evaluate() const noexcept override;
+    void set_argument(const std::size_t index, Expression* argument) noexcept
+    {
+        m_arguments[index] = argument;
+    }
+
+    void emit(fmt::memory_buffer& out) const noexcept override;
 
   private:
-    std::shared_ptr<Expression>              m_function_name;
-    std::vector<std::shared_ptr<Expression>> m_arguments;
+    Expression*              m_function_name;
+    std::vector<Expression*> m_arguments;
 };
 
 class [[nodiscard]] IndexOperatorExpression final : public Expression
 {
   public:
-    IndexOperatorExpression(std::shared_ptr<Expression> variable_name, std::shared_ptr<Expression> index) noexcept;
+    static constexpr Kind static_kind = Kind::INDEX_OPERATOR;
+
+    IndexOperatorExpression(Expression* variable_name, Expression* index, Position position) noexcept;
+
+    void emit(fmt::memory_buffer& out) const noexcept override;
+
+    [[nodiscard]] Expression* variable_name() const noexcept { return m_variable_name; }
+
+    [[nodiscard]] Expression* index() const noexcept { return m_index; }
 
-    [[nodiscard]] std::string evaluate() const noexcept override;
+    void set_variable_name(Expression* variable_name) noexcept { m_variable_name = variable_name; }
+
+    void set_index(Expression* index) noexcept { m_index = index; }
 
   private:
-    std::shared_ptr<Expression> m_variable_name;
-    std::shared_ptr<Expression> m_index;
+    Expression* m_variable_name;
+    Expression* m_index;
 };
 
 
 class [[nodiscard]] AssignmentExpression final : public Expression
 {
   public:
+    static constexpr Kind static_kind = Kind::ASSIGNMENT;
+
     AssignmentExpression(
-        std::shared_ptr<Expression> lhs,
-        Token::Type                 assignment_operator,
-        std::shared_ptr<Expression> rhs) noexcept;
+        Expression* lhs,
+        Token::Type assignment_operator,
+        Expression* rhs,
+        Position    position) noexcept;
+
+    void emit(fmt::memory_buffer& out) const noexcept override;
+
+    [[nodiscard]] Expression* lhs() const noexcept { return m_lhs; }
 
-    [[nodiscard]] std::string evaluate() const noexcept override;
+    [[nodiscard]] Token::Type operator_type() const noexcept { return m_operator; }
+
+    [[nodiscard]] Expression* rhs() const noexcept { return m_rhs; }
+
+    void set_rhs(Expression* rhs) noexcept { m_rhs = rhs; }
 
   private:
-    std::shared_ptr<Expression> m_lhs;
-    Token::Type                 m_operator;
-    std::shared_ptr<Expression> m_rhs;
+    Expression* m_lhs;
+    Token::Type m_operator;
+    Expression* m_rhs;
 };
 
 
 class [[nodiscard]] LogicalExpression final : public Expression
 {
   public:
+    static constexpr Kind static_kind = Kind::LOGICAL;
+
     LogicalExpression(
-        std::shared_ptr<Expression> left,
-        Token::Type                 logical_operator,
-        std::shared_ptr<Expression> right) noexcept;
+        Expression* left,
+        Token::Type logical_operator,
+        Expression* right,
+        Position    position) noexcept;
+
+    void emit(fmt::memory_buffer& out) const noexcept override;
 
-    [[nodiscard]] std::string evaluate() const noexcept override;
+    [[nodiscard]] Token::Type operator_type() const noexcept { return m_operator; }
+
+    [[nodiscard]] Expression* left() const noexcept { return m_left; }
+
+    [[nodiscard]] Expression* right() const noexcept { return m_right; }
+
+    void set_left(Expression* left) noexcept { m_left = left; }
+
+    void set_right(Expression* right) noexcept { m_right = right; }
 
   private:
-    std::shared_ptr<Expression> m_left;
-    Token::Type                 m_operator;
-    std::shared_ptr<Expression> m_right;
+    Expression* m_left;
+    Token::Type m_operator;
+    Expression* m_right;
 };
 
 
 class [[nodiscard]] GroupingExpression final : public Expression
 {
   public:
-    explicit GroupingExpression(std::shared_ptr<Expression> expression) noexcept;
+    static constexpr Kind static_kind = Kind::GROUPING;
 
-    [[nodiscard]] std::string evaluate() const noexcept override;
+    GroupingExpression(Expression* expression, Position position) noexcept;
+
+    void emit(fmt::memory_buffer& out) const noexcept override;
+
+    [[nodiscard]] Expression* expression() const noexcept { return m_expression; }
+
+    void set_expression(Expression* expression) noexcept { m_expression = expression; }
 
   private:
-    std::shared_ptr<Expression> m_expression;
+    Expression* m_expression;
 };
 
 
 class [[nodiscard]] EnumExpression final : public Expression
 {
   public:
-    EnumExpression(std::shared_ptr<Expression> enum_base, std::shared_ptr<Expression> enum_variant) noexcept;
+    static constexpr Kind static_kind = Kind::ENUM;
+
+    EnumExpression(Expression* enum_base, Expression* enum_variant, Position position) noexcept;
 
-    [[nodiscard]] std::shared_ptr<Expression> enum_base() const noexcept
+    [[nodiscard]] Expression* enum_base() const noexcept
     {
         return m_enum_base;
     }
 
-    [[nodiscard]] std::shared_ptr<Expression> enum_variant() const noexcept
+    [[nodiscard]] Expression* enum_variant() const noexcept
     {
         return m_enum_variant;
     }
 
-    [[nodiscard]] std::string evaluate() const noexcept override;
+    void emit(fmt::memory_buffer& out) const noexcept override;
 
   private:
-    std::shared_ptr<Expression> m_enum_base;
-    std::shared_ptr<Expression> m_enum_variant;
+    Expression* m_enum_base;
+    Expression* m_enum_variant;
 };
+
+template <typename Visitor>
+decltype(auto) Expression::visit(Visitor&& visitor)
+{
+    switch (m_kind) {
+        case Kind::UNARY: {
+            return visitor(static_cast<UnaryExpression&>(*this));
+        }
+        case Kind::VARIABLE: {
+            return visitor(static_cast<VariableExpression&>(*this));
+        }
+        case Kind::BINARY: {
+            return visitor(static_cast<BinaryExpression&>(*this));
+        }
+        case Kind::LITERAL: {
+            return visitor(static_cast<LiteralExpression&>(*this));
+        }
+        case Kind::FUNCTION_CALL: {
+            return visitor(static_cast<FunctionCallExpression&>(*this));
+        }
+        case Kind::INDEX_OPERATOR: {
+            return visitor(static_cast<IndexOperatorExpression&>(*this));
+        }
+        case Kind::ASSIGNMENT: {
+            return visitor(static_cast<AssignmentExpression&>(*this));
+        }
+        case Kind::LOGICAL: {
+            return visitor(static_cast<LogicalExpression&>(*this));
+        }
+        case Kind::GROUPING: {
+            return visitor(static_cast<GroupingExpression&>(*this));
+        }
+        case Kind::ENUM: {
+            return visitor(static_cast<EnumExpression&>(*this));
+        }
+    }
+
+    std::unreachable();
+}
+
+template <typename Visitor>
+decltype(auto) Expression::visit(Visitor&& visitor) const
+{
+    switch (m_kind) {
+        case Kind::UNARY: {
+            return visitor(static_cast<const UnaryExpression&>(*this));
+        }
+        case Kind::VARIABLE: {
+            return visitor(static_cast<const VariableExpression&>(*this));
+        }
+        case Kind::BINARY: {
+            return visitor(static_cast<const BinaryExpression&>(*this));
+        }
+        case Kind::LITERAL: {
+            return visitor(static_cast<const LiteralExpression&>(*this));
+        }
+        case Kind::FUNCTION_CALL: {
+            return visitor(static_cast<const FunctionCallExpression&>(*this));
+        }
+        case Kind::INDEX_OPERATOR: {
+            return visitor(static_cast<const IndexOperatorExpression&>(*this));
+        }
+        case Kind::ASSIGNMENT: {
+            return visitor(static_cast<const AssignmentExpression&>(*this));
+        }
+        case Kind::LOGICAL: {
+            return visitor(static_cast<const LogicalExpression&>(*this));
+        }
+        case Kind::GROUPING: {
+            return visitor(static_cast<const GroupingExpression&>(*this));
+        }
+        case Kind::ENUM: {
+            return visitor(static_cast<const EnumExpression&>(*this));
+        }
+    }
+
+    std::unreachable();
+}
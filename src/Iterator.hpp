@@ -1,6 +1,7 @@
 #pragma once
 
 #include <optional>
+#include <utility>
 
 template <typename Iterable>
 class [[nodiscard]] Iterator
@@ -12,7 +13,10 @@ class [[nodiscard]] Iterator
   protected:
     using value_type = typename Iterable::value_type;
 
-    explicit Iterator(const Iterable& data) noexcept;
+    // Iterable is either an owning container, which is moved in, or a
+    // non-owning view (std::string_view, std::span) over data kept alive
+    // elsewhere. In neither case the underlying elements are copied.
+    explicit Iterator(Iterable data) noexcept;
 
     [[nodiscard]] bool eof() const noexcept;
 
@@ -30,6 +34,7 @@ class [[nodiscard]] Iterator
 
     [[nodiscard]] std::size_t cursor() const noexcept;
 
+    [[nodiscard]] const Iterable& data() const noexcept;
 
   private:
     Iterable    m_data;
@@ -37,7 +42,7 @@ class [[nodiscard]] Iterator
 };
 
 template <typename Iterable>
-Iterator<Iterable>::Iterator(const Iterable& data) noexcept : m_data{data}
+Iterator<Iterable>::Iterator(Iterable data) noexcept : m_data{std::move(data)}
 {
 }
 
@@ -82,6 +87,12 @@ std::size_t Iterator<Iterable>::cursor() const noexcept
     return m_cursor;
 }
 
+template <typename Iterable>
+const Iterable& Iterator<Iterable>::data() const noexcept
+{
+    return m_data;
+}
+
 template <typename Iterable>
 std::optional<typename Iterator<Iterable>::value_type>
 Iterator<Iterable>::peek_behind(const std::size_t offset) const noexcept
@@ -1,8 +1,15 @@
 #include "Lexer.hpp"
 
-std::vector<Token> Lexer::lex(std::string source, const std::shared_ptr<Supervisor>& supervisor)
+std::vector<Token> Lexer::lex(const Position::SourceId source_id, const std::shared_ptr<Supervisor>& supervisor)
 {
-    Lexer lexer(std::move(source), supervisor);
+    const auto source = supervisor->source(source_id);
+    if (source.size() > Position::max_offset) {
+        supervisor->push_error(
+            "source file is larger than 4 GiB", Position::create(source_id, 0, 0));
+        return {};
+    }
+
+    Lexer lexer(source_id, source, supervisor);
 
     std::vector<Token> tokens;
     while (!lexer.eof() && !supervisor->has_errors()) {
@@ -15,9 +22,13 @@ std::vector<Token> Lexer::lex(std::string source, const std::shared_ptr<Supervis
     return tokens;
 }
 
-Lexer::Lexer(std::string&& source, const std::shared_ptr<Supervisor>& supervisor) noexcept
+Lexer::Lexer(
+    const Position::SourceId           source_id,
+    std::string_view                   source,
+    const std::shared_ptr<Supervisor>& supervisor) noexcept
     : Iterator(source),
-      m_supervisor{supervisor}
+      m_supervisor{supervisor},
+      m_source_id{source_id}
 {
 }
 
@@ -36,32 +47,32 @@ Token Lexer::next_token()
         case '\n': {
             advance(1);
             return Token::create(
-                Token::Type::END_OF_LINE, "\n", Position::create(cursor(), cursor()));
+                Token::Type::END_OF_LINE, "\n", position_from(cursor()));
         }
         case '(': {
             advance(1);
             return Token::create(
-                Token::Type::LEFT_PAREN, "(", Position::create(cursor(), cursor()));
+                Token::Type::LEFT_PAREN, "(", position_from(cursor()));
         }
         case ')': {
             advance(1);
             return Token::create(
-                Token::Type::RIGHT_PAREN, ")", Position::create(cursor(), cursor()));
+                Token::Type::RIGHT_PAREN, ")", position_from(cursor()));
         }
         case '{': {
             advance(1);
             return Token::create(
-                Token::Type::LEFT_BRACE, "{", Position::create(cursor(), cursor()));
+                Token::Type::LEFT_BRACE, "{", position_from(cursor()));
         }
         case '}': {
             advance(1);
             return Token::create(
-                Token::Type::RIGHT_BRACE, "}", Position::create(cursor(), cursor()));
+                Token::Type::RIGHT_BRACE, "}", position_from(cursor()));
         }
         case ';': {
             advance(1);
             return Token::create(
-                Token::Type::SEMICOLON, ";", Position::create(cursor(), cursor()));
+                Token::Type::SEMICOLON, ";", position_from(cursor()));
         }
         case '*': {
             return lex_star();
@@ -69,26 +80,26 @@ Token Lexer::next_token()
         case ',': {
             advance(1);
             return Token::create(
-                Token::Type::COMMA, ",", Position::create(cursor(), cursor()));
+                Token::Type::COMMA, ",", position_from(cursor()));
         }
         case '&': {
             advance(1);
             return Token::create(
-                Token::Type::AMPERSAND, "&", Position::create(cursor(), cursor()));
+                Token::Type::AMPERSAND, "&", position_from(cursor()));
         }
         case '[': {
             advance(1);
             return Token::create(
-                Token::Type::LEFT_BRACKET, "[", Position::create(cursor(), cursor()));
+                Token::Type::LEFT_BRACKET, "[", position_from(cursor()));
         }
         case ']': {
             advance(1);
             return Token::create(
-                Token::Type::RIGHT_BRACKET, "]", Position::create(cursor(), cursor()));
+                Token::Type::RIGHT_BRACKET, "]", position_from(cursor()));
         }
         case '.': {
             advance(1);
-            return Token::create(Token::Type::DOT, ".", Position::create(cursor(), cursor()));
+            return Token::create(Token::Type::DOT, ".", position_from(cursor()));
         }
         case '/': {
             return lex_slash();
@@ -128,14 +139,7 @@ Token Lexer::next_token()
 
 void Lexer::skip_whitespaces() noexcept
 {
-    consume_chars([this](const auto& ch) {
-        if (ch == ' ' || ch == '\t' || ch == '\r') {
-            advance(1);
-            return dts::IteratorDecision::Continue;
-        }
-
-        return dts::IteratorDecision::Break;
-    });
+    advance(Scanner::span_whitespaces(data(), cursor()));
 }
 
 Token Lexer::lex_keyword_or_identifier() noexcept
@@ -144,23 +148,14 @@ Token Lexer::lex_keyword_or_identifier() noexcept
 
     if (std::isdigit(peek().value()) != 0) { return lex_number(); }
 
-    std::string value;
-    consume_chars([this, &value](const auto& ch) {
-        if (std::isalnum(ch) != 0 || ch == '_') {
-            value += ch;
-            advance(1);
-            return dts::IteratorDecision::Continue;
-        }
-
-        return dts::IteratorDecision::Break;
-    });
+    advance(Scanner::span_identifier(data(), cursor()));
 
+    const auto value = lexeme_from(start);
     if (const auto keyword = Token::is_keyword(value); keyword.has_value()) {
-        return Token::create(*keyword, std::move(value), Position::create(start, cursor()));
+        return Token::create(*keyword, value, position_from(start));
     }
 
-    return Token::create(
-        Token::Type::IDENTIFIER, std::move(value), Position::create(start, cursor()));
+    return Token::create(Token::Type::IDENTIFIER, value, position_from(start));
 }
 
 Token Lexer::lex_minus() noexcept
@@ -171,17 +166,17 @@ Token Lexer::lex_minus() noexcept
 
     if (ch == '>') {
         advance(2);
-        return Token::create(Token::Type::ARROW, "->", Position::create(start, cursor()));
+        return Token::create(Token::Type::ARROW, "->", position_from(start));
     }
 
     if (ch = peek_ahead(1); ch == '-') {
         advance(2);
         return Token::create(
-            Token::Type::MINUS_MINUS, "--", Position::create(start, cursor()));
+            Token::Type::MINUS_MINUS, "--", position_from(start));
     }
 
     advance(1);
-    return Token::create(Token::Type::MINUS, "-", Position::create(start, cursor()));
+    return Token::create(Token::Type::MINUS, "-", position_from(start));
 }
 
 Token Lexer::lex_equal_sign() noexcept
@@ -191,23 +186,23 @@ Token Lexer::lex_equal_sign() noexcept
     if (auto ch = peek_ahead(1); ch == '=') {
         advance(2);
         return Token::create(
-            Token::Type::EQUAL_EQUAL, "==", Position::create(start, cursor()));
+            Token::Type::EQUAL_EQUAL, "==", position_from(start));
     }
 
     if (auto ch = peek_ahead(1); ch == '>') {
         advance(2);
-        return Token::create(Token::Type::FAT_ARROW, "=>", Position::create(start, cursor()));
+        return Token::create(Token::Type::FAT_ARROW, "=>", position_from(start));
     }
 
     advance(1);
-    return Token::create(Token::Type::EQUAL, "=", Position::create(start, cursor()));
+    return Token::create(Token::Type::EQUAL, "=", position_from(start));
 }
 
 Token Lexer::lex_star() noexcept
 {
     const auto start = cursor();
     advance(1);
-    return Token::create(Token::Type::STAR, "*", Position::create(start, cursor()));
+    return Token::create(Token::Type::STAR, "*", position_from(start));
 }
 
 Token Lexer::lex_plus() noexcept
@@ -219,16 +214,16 @@ Token Lexer::lex_plus() noexcept
     if (ch == '=') {
         advance(2);
         return Token::create(
-            Token::Type::PLUS_EQUAL, "+=", Position::create(start, cursor()));
+            Token::Type::PLUS_EQUAL, "+=", position_from(start));
     }
 
     if (ch = peek_ahead(1); ch == '+') {
         advance(2);
-        return Token::create(Token::Type::PLUS_PLUS, "++", Position::create(start, cursor()));
+        return Token::create(Token::Type::PLUS_PLUS, "++", position_from(start));
     }
 
     advance(1);
-    return Token::create(Token::Type::PLUS, "+", Position::create(start, cursor()));
+    return Token::create(Token::Type::PLUS, "+", position_from(start));
 }
 
 Token Lexer::lex_less_than() noexcept
@@ -238,11 +233,11 @@ Token Lexer::lex_less_than() noexcept
     if (auto ch = peek_ahead(1); ch == '=') {
         advance(2);
         return Token::create(
-            Token::Type::LESS_EQUAL, "<=", Position::create(start, cursor()));
+            Token::Type::LESS_EQUAL, "<=", position_from(start));
     }
 
     advance(1);
-    return Token::create(Token::Type::LESS, "<", Position::create(start, cursor()));
+    return Token::create(Token::Type::LESS, "<", position_from(start));
 }
 
 Token Lexer::lex_single_quoted_string()
@@ -257,33 +252,24 @@ Token Lexer::lex_single_quoted_string()
     if (!quoted || !ending_quote || ending_quote.value() != '\'') {
         m_supervisor->push_error(
             "unterminated or empty single quoted string",
-            Position::create(start, cursor()));
+            position_from(start));
         return Token::create_dumb();
     }
 
     return Token::create(
         Token::Type::SINGLE_QUOTED_STRING,
-        std::string(1, quoted.value()),
-        Position::create(start, cursor()));
+        data().substr(start + 1, 1),
+        position_from(start));
 }
 
 Token Lexer::lex_number() noexcept
 {
     const auto start = cursor();
 
-    std::string value;
-    consume_chars([this, &value](const auto& ch) {
-        if (std::isdigit(ch) != 0) {
-            value += ch;
-            advance(1);
-            return dts::IteratorDecision::Continue;
-        }
-
-        return dts::IteratorDecision::Break;
-    });
+    advance(Scanner::span_digits(data(), cursor()));
 
     return Token::create(
-        Token::Type::NUMBER, std::move(value), Position::create(start, cursor()));
+        Token::Type::NUMBER, lexeme_from(start), position_from(start));
 }
 
 Token Lexer::lex_double_quoted_string() noexcept
@@ -293,29 +279,14 @@ Token Lexer::lex_double_quoted_string() noexcept
     // Skip the opening double quote
     advance(1);
 
-    std::string value;
-    consume_chars([this, &value](const auto& ch) {
-        if (ch != '"') {
-            value += ch;
-            advance(1);
-            return dts::IteratorDecision::Continue;
-        }
-
-        if (ch == '\n') {
-            m_supervisor->push_error(
-                "unterminated double quoted string", Position::create(cursor(), cursor()));
-            return dts::IteratorDecision::Break;
-        }
-
-        return dts::IteratorDecision::Break;
-    });
+    advance(Scanner::span_string_body(data(), cursor()));
 
     // Skip the ending double quote
     advance(1);
 
-    value = fmt::format("\"{}\"", value);
+    // The lexeme keeps both quotes, so it can be sliced straight from the source
     return Token::create(
-        Token::Type::DOUBLE_QUOTED_STRING, std::move(value), Position::create(start, cursor()));
+        Token::Type::DOUBLE_QUOTED_STRING, lexeme_from(start), position_from(start));
 }
 
 Token Lexer::lex_colon() noexcept
@@ -325,11 +296,11 @@ Token Lexer::lex_colon() noexcept
     if (auto ch = peek_ahead(1); ch == ':') {
         advance(2);
         return Token::create(
-            Token::Type::COLON_COLON, "::", Position::create(start, cursor()));
+            Token::Type::COLON_COLON, "::", position_from(start));
     }
 
     advance(1);
-    return Token::create(Token::Type::COLON, ":", Position::create(start, cursor()));
+    return Token::create(Token::Type::COLON, ":", position_from(start));
 }
 
 Token Lexer::lex_slash() noexcept
@@ -342,7 +313,7 @@ Token Lexer::lex_slash() noexcept
     }
 
     advance(1);
-    return Token::create(Token::Type::SLASH, "/", Position::create(start, cursor()));
+    return Token::create(Token::Type::SLASH, "/", position_from(start));
 }
 Token Lexer::lex_bang() noexcept
 {
@@ -351,11 +322,11 @@ Token Lexer::lex_bang() noexcept
     if (const auto ch = peek_ahead(1); ch == '=') {
         advance(2);
         return Token::create(
-            Token::Type::BANG_EQUAL, "!=", Position::create(start, cursor()));
+            Token::Type::BANG_EQUAL, "!=", position_from(start));
     }
 
     advance(1);
-    return Token::create(Token::Type::BANG, "!", Position::create(start, cursor()));
+    return Token::create(Token::Type::BANG, "!", position_from(start));
 }
 Token Lexer::lex_greater_than() noexcept
 {
@@ -364,19 +335,9 @@ Token Lexer::lex_greater_than() noexcept
     if (const auto ch = peek_ahead(1); ch == '=') {
         advance(2);
         return Token::create(
-            Token::Type::GREATER_EQUAL, ">=", Position::create(start, cursor()));
+            Token::Type::GREATER_EQUAL, ">=", position_from(start));
     }
 
     advance(1);
-    return Token::create(Token::Type::GREATER, ">", Position::create(start, cursor()));
-}
-
-template <std::invocable<char> Callable>
-void Lexer::consume_chars(Callable&& callable) noexcept
-{
-    while (!eof()) {
-        const auto iterator_decision = callable(*peek());
-        if (iterator_decision == dts::IteratorDecision::Break) { break; }
-        if (iterator_decision == dts::IteratorDecision::Continue) { continue; }
-    }
+    return Token::create(Token::Type::GREATER, ">", position_from(start));
 }
@@ -1,26 +1,31 @@
 #pragma once
 
-#include <concepts>
 #include <expected>
 #include <memory>
+#include <string_view>
 #include <vector>
 
-#include <dtsutil/iterator.hpp>
 #include <fmt/format.h>
 
 #include "Iterator.hpp"
 #include "Position.hpp"
+#include "Scanner.hpp"
 #include "Supervisor.hpp"
 #include "Token.hpp"
 
-class [[nodiscard]] Lexer : public Iterator<std::string>
+class [[nodiscard]] Lexer : public Iterator<std::string_view>
 {
   public:
+    // Lexes the source stored in `supervisor` under `source_id`, every token
+    // position points back into it
     [[nodiscard]] static std::vector<Token>
-    lex(std::string source, const std::shared_ptr<Supervisor>& supervisor);
+    lex(Position::SourceId source_id, const std::shared_ptr<Supervisor>& supervisor);
 
   private:
-    explicit Lexer(std::string&& source, const std::shared_ptr<Supervisor>& supervisor) noexcept;
+    explicit Lexer(
+        Position::SourceId                 source_id,
+        std::string_view                   source,
+        const std::shared_ptr<Supervisor>& supervisor) noexcept;
 
     [[nodiscard]] Token next_token();
 
@@ -52,10 +57,18 @@ class [[nodiscard]] Lexer : public Iterator<std::string>
 
     [[nodiscard]] Token lex_greater_than() noexcept;
 
-    template <std::invocable<char> Callable>
-    void consume_chars(Callable&& callable) noexcept;
-
     [[nodiscard]] bool eol() const noexcept { return peek() == '\n'; }
 
+    [[nodiscard]] std::string_view lexeme_from(const std::size_t start) const noexcept
+    {
+        return data().substr(start, cursor() - start);
+    }
+
+    [[nodiscard]] Position position_from(const std::size_t start) const noexcept
+    {
+        return Position::create(m_source_id, start, cursor());
+    }
+
     std::shared_ptr<Supervisor> m_supervisor;
+    Position::SourceId          m_source_id;
 };
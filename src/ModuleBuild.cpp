@@ -0,0 +1,198 @@
+#include "ModuleBuild.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <expected>
+#include <fstream>
+#include <string>
+#include <system_error>
+#include <thread>
+
+#include <dtsutil/process.hpp>
+#include <fmt/color.h>
+#include <fmt/format.h>
+
+#include "TimeReport.hpp"
+
+namespace
+{
+
+using CompileResult = std::expected<dts::ProcessResult, dts::ProcessError>;
+
+struct TranslationUnit
+{
+    std::filesystem::path source;
+    std::filesystem::path object;
+};
+
+template <typename... Args>
+void report(fmt::format_string<Args...> format, Args&&... args)
+{
+    fmt::print(
+        stderr,
+        fmt::emphasis::bold | fmt::fg(fmt::color::red),
+        "{}\n",
+        fmt::format(format, std::forward<Args>(args)...));
+}
+
+[[nodiscard]] bool write_file(const std::filesystem::path& path, const fmt::memory_buffer& contents)
+{
+    ScopedTimer timer(TimeReport::Phase::WRITE);
+    timer.add_bytes(contents.size());
+
+    std::ofstream file(path, std::ios::binary);
+    file.write(contents.data(), static_cast<std::streamsize>(contents.size()));
+    return file.good();
+}
+
+// Writes a header and a source file per module. A module's source includes
+// the headers of every module up to its own, so it sees exactly the
+// declarations it saw when the program was a single translation unit.
+[[nodiscard]] std::vector<TranslationUnit> write_translation_units(
+    const std::vector<ModuleStatement*>& modules, const std::filesystem::path& work_directory)
+{
+    std::vector<TranslationUnit> units;
+    std::vector<std::string>     headers;
+    fmt::memory_buffer           buffer;
+
+    for (std::size_t i = 0; i < modules.size(); ++i) {
+        const auto* modul = modules[i];
+        const auto  stem  = fmt::format("{}_{}", i, modul->name());
+
+        {
+            ScopedTimer timer(TimeReport::Phase::CODEGEN, stem + ".hpp");
+            buffer.clear();
+            buffer.append(std::string_view("#pragma once\n\n"));
+            modul->emit_declarations(buffer);
+            timer.add_bytes(buffer.size());
+        }
+        headers.push_back(stem + ".hpp");
+        if (!write_file(work_directory / headers.back(), buffer)) {
+            report("error while writing {}", (work_directory / headers.back()).string());
+            return {};
+        }
+
+        {
+            ScopedTimer timer(TimeReport::Phase::CODEGEN, stem + ".cpp");
+            buffer.clear();
+            for (const auto& header : headers) {
+                fmt::format_to(std::back_inserter(buffer), "#include \"{}\"\n", header);
+            }
+            buffer.push_back('\n');
+            modul->emit_definitions(buffer);
+            timer.add_bytes(buffer.size());
+            timer.add_items(1);
+        }
+
+        auto& unit  = units.emplace_back();
+        unit.source = work_directory / (stem + ".cpp");
+        unit.object = work_directory / (stem + ".o");
+        if (!write_file(unit.source, buffer)) {
+            report("error while writing {}", unit.source.string());
+            return {};
+        }
+    }
+
+    return units;
+}
+
+// Compiles every unit on up to `jobs` concurrent compiler processes. Their
+// output is captured, so diagnostics of different units never interleave.
+[[nodiscard]] std::vector<CompileResult> compile_translation_units(
+    const std::vector<TranslationUnit>& units, const ModuleBuild::Options& options)
+{
+    std::vector<CompileResult> results(units.size());
+    std::atomic<std::size_t>   next_unit = 0;
+
+    const auto worker = [&]() noexcept {
+        for (auto i = next_unit++; i < units.size(); i = next_unit++) {
+            std::vector<std::string> arguments{std::string(options.compiler)};
+            for (const auto flag : options.compile_flags) { arguments.emplace_back(flag); }
+            arguments.insert(
+                arguments.end(),
+                {"-c", "-o", units[i].object.string(), units[i].source.string()});
+
+            dts::ProcessOptions process_options;
+            process_options.capture_output = true;
+
+            ScopedTimer timer(TimeReport::Phase::COMPILE);
+            TraceSpan   span("gcc", units[i].source.filename().string());
+            results[i] = dts::subprocess_run(arguments, process_options);
+            timer.add_items(1);
+        }
+    };
+
+    const auto worker_count = std::clamp<std::size_t>(options.jobs, 1, units.size());
+
+    std::vector<std::jthread> workers;
+    workers.reserve(worker_count - 1);
+    for (std::size_t i = 1; i < worker_count; ++i) { workers.emplace_back(worker); }
+    worker();
+
+    return results;
+}
+
+} // namespace
+
+bool ModuleBuild::run(const std::vector<ModuleStatement*>& modules, const Options& options) noexcept
+{
+    if (modules.empty()) { return false; }
+
+    std::error_code error;
+    std::filesystem::create_directories(options.work_directory, error);
+    if (error) {
+        report(
+            "error while creating {}: {}", options.work_directory.string(), error.message());
+        return false;
+    }
+
+    const auto units = write_translation_units(modules, options.work_directory);
+    if (units.empty()) { return false; }
+
+    const auto results = compile_translation_units(units, options);
+
+    // Reported in module order, whichever unit finished first
+    bool compiled = true;
+    for (std::size_t i = 0; i < units.size(); ++i) {
+        const auto& result = results[i];
+        if (!result) {
+            report(
+                "error while invoking the compiler on {}: {}",
+                units[i].source.string(),
+                result.error().message.value_or("unknown error"));
+            compiled = false;
+            continue;
+        }
+
+        std::fwrite(result->stdout_output.data(), 1, result->stdout_output.size(), stdout);
+        std::fwrite(result->stderr_output.data(), 1, result->stderr_output.size(), stderr);
+        if (!result->success()) {
+            report("failed to compile {}", units[i].source.string());
+            compiled = false;
+        }
+    }
+    if (!compiled) { return false; }
+
+    std::vector<std::string> link_arguments{
+        std::string(options.compiler), "-o", options.output.string()};
+    for (const auto& unit : units) { link_arguments.push_back(unit.object.string()); }
+
+    const auto link_result = [&link_arguments] {
+        ScopedTimer timer(TimeReport::Phase::LINK);
+        TraceSpan   span("gcc", "link");
+        return dts::subprocess_run(link_arguments);
+    }();
+    if (!link_result) {
+        report(
+            "error while invoking the linker: {}",
+            link_result.error().message.value_or("unknown error"));
+        return false;
+    }
+    if (!link_result->success()) {
+        report("failed to link {}", options.output.string());
+        return false;
+    }
+
+    return true;
+}
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <cstddef>
+#include <filesystem>
+#include <span>
+#include <string_view>
+#include <vector>
+
+#include "Statement.hpp"
+
+// Builds a program as one translation unit per module. Every module gets a
+// header with its declarations and a source file with its function
+// definitions, the sources are compiled to objects by a pool of compiler
+// processes and the objects are linked into the final binary.
+class [[nodiscard]] ModuleBuild
+{
+  public:
+    struct Options
+    {
+        std::string_view                  compiler;
+        std::span<const std::string_view> compile_flags;
+        std::filesystem::path             work_directory;
+        std::filesystem::path             output;
+        std::size_t                       jobs;
+    };
+
+    // Reports compiler diagnostics and failures on stderr
+    [[nodiscard]] static bool
+    run(const std::vector<ModuleStatement*>& modules, const Options& options) noexcept;
+};
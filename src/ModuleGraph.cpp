@@ -0,0 +1,180 @@
+#include "ModuleGraph.hpp"
+
+#include <algorithm>
+#include <system_error>
+#include <utility>
+
+#include <dtsutil/filesystem.hpp>
+#include <fmt/format.h>
+
+#include "Lexer.hpp"
+#include "Parser.hpp"
+#include "TimeReport.hpp"
+
+namespace
+{
+
+[[nodiscard]] std::filesystem::path canonical_path(const std::filesystem::path& path) noexcept
+{
+    std::error_code error;
+    auto            canonical = std::filesystem::weakly_canonical(path, error);
+    return error ? path.lexically_normal() : canonical;
+}
+
+} // namespace
+
+ModuleGraph::ModuleGraph(const std::shared_ptr<Supervisor>& supervisor, const std::size_t thread_count)
+    : m_supervisor{supervisor},
+      m_thread_count{std::max<std::size_t>(thread_count, 1)}
+{
+}
+
+std::vector<ModuleStatement*> ModuleGraph::build(const std::span<const Token> root_tokens) noexcept
+{
+    // The root was lexed against the main supervisor, its diagnostics go
+    // straight there and come first
+    const auto root_path = canonical_path(m_supervisor->project_root());
+    {
+        std::scoped_lock lock(m_mutex);
+        m_modules.emplace_back(root_path, m_supervisor);
+        m_module_ids.emplace(root_path.string(), 0);
+    }
+
+    // Only the root's own imports can start the pool, so once it is parsed
+    // the pool either exists or is never needed
+    parse(0, root_tokens);
+    if (m_pool) { m_pool->wait(); }
+
+    std::vector<State>            states(m_modules.size(), State::UNVISITED);
+    std::vector<ModuleId>         import_stack;
+    std::vector<ModuleStatement*> ordered;
+    order(0, states, import_stack, ordered);
+
+    return ordered;
+}
+
+void ModuleGraph::import(const ModuleId importer, const std::filesystem::path& path, const Position position) noexcept
+{
+    const auto module_path = canonical_path(path);
+
+    std::scoped_lock lock(m_mutex);
+
+    // Every module becomes a source file, and positions only have room for
+    // so many of those
+    if (m_modules.size() >= Position::max_sources && !m_module_ids.contains(module_path.string())) {
+        m_modules[importer].supervisor->push_error(
+            fmt::format("Too many modules, at most {} are supported", Position::max_sources),
+            position);
+        return;
+    }
+
+    auto [entry, inserted] = m_module_ids.try_emplace(module_path.string(), m_modules.size());
+    m_modules[importer].imports.push_back(Import{.module = entry->second, .position = position});
+    if (!inserted) { return; }
+
+    m_modules.emplace_back(module_path, m_supervisor->create_module_supervisor());
+    if (!m_pool) { m_pool.emplace(m_thread_count); }
+    m_pool->submit([this, id = entry->second] { load(id); });
+}
+
+ModuleGraph::Module& ModuleGraph::module(const ModuleId id) noexcept
+{
+    // References into the deque stay valid while other threads append to
+    // it, only the lookup itself needs the lock
+    std::scoped_lock lock(m_mutex);
+    return m_modules[id];
+}
+
+void ModuleGraph::load(const ModuleId id) noexcept
+{
+    auto&      loaded    = module(id);
+    const auto file_name = loaded.path.filename().string();
+
+    Supervisor::SourceId source_id = 0;
+    {
+        ScopedTimer timer(TimeReport::Phase::READ, file_name);
+
+        auto module_content = dts::map_file(loaded.path.string());
+        if (!module_content) {
+            loaded.found = false;
+            return;
+        }
+
+        source_id = m_supervisor->store_source(std::move(*module_content), loaded.path);
+        timer.add_bytes(m_supervisor->source(source_id).size());
+    }
+
+    std::vector<Token> lexed_tokens;
+    {
+        ScopedTimer timer(TimeReport::Phase::LEX, file_name);
+        lexed_tokens = Lexer::lex(source_id, loaded.supervisor);
+        timer.add_bytes(m_supervisor->source(source_id).size());
+        timer.add_items(lexed_tokens.size());
+    }
+    if (loaded.supervisor->has_errors()) { return; }
+
+    parse(id, lexed_tokens);
+}
+
+void ModuleGraph::parse(const ModuleId id, const std::span<const Token> tokens) noexcept
+{
+    auto& parsed = module(id);
+
+    ScopedTimer timer(TimeReport::Phase::PARSE, parsed.path.filename().string());
+
+    // Imports met by the parser are queued on the pool right away, so they
+    // load while the rest of this module is parsed
+    parsed.statements = Parser::parse(tokens, parsed.supervisor, parsed.arena, *this, id);
+
+    timer.add_bytes(parsed.arena.bytes_allocated());
+    timer.add_items(parsed.arena.objects_created());
+}
+
+void ModuleGraph::order(
+    const ModuleId                 id,
+    std::vector<State>&            states,
+    std::vector<ModuleId>&         import_stack,
+    std::vector<ModuleStatement*>& ordered) noexcept
+{
+    states[id] = State::IN_PROGRESS;
+    import_stack.push_back(id);
+
+    auto& current = m_modules[id];
+    for (const auto& [imported, position] : current.imports) {
+        if (!m_modules[imported].found) {
+            current.supervisor->push_error(
+                fmt::format(
+                    "Could not import module: {}", m_modules[imported].path.filename().string()),
+                position);
+        } else if (states[imported] == State::IN_PROGRESS) {
+            current.supervisor->push_error(
+                fmt::format("Import cycle: {}", cycle_description(import_stack, imported)),
+                position);
+        } else if (states[imported] == State::UNVISITED) {
+            order(imported, states, import_stack, ordered);
+        }
+    }
+
+    m_supervisor->take_errors(*current.supervisor);
+    ordered.insert(ordered.end(), current.statements.begin(), current.statements.end());
+
+    import_stack.pop_back();
+    states[id] = State::DONE;
+}
+
+std::string ModuleGraph::cycle_description(const std::vector<ModuleId>& import_stack, const ModuleId repeated) const
+{
+    const auto root_directory = m_modules.front().path.parent_path();
+    const auto relative_path  = [this, &root_directory](const ModuleId id) {
+        return m_modules[id].path.lexically_relative(root_directory).string();
+    };
+
+    std::string description;
+    for (auto id = std::ranges::find(import_stack, repeated); id != import_stack.end(); ++id) {
+        description += relative_path(*id);
+        description += " -> ";
+    }
+    description += relative_path(repeated);
+
+    return description;
+}
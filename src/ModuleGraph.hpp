@@ -0,0 +1,103 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "Arena.hpp"
+#include "Position.hpp"
+#include "Statement.hpp"
+#include "Supervisor.hpp"
+#include "ThreadPool.hpp"
+#include "Token.hpp"
+
+// The modules of a project and the imports between them. Modules are keyed
+// by canonical path, so each file is read, lexed and parsed once however many
+// modules import it. Modules are loaded on a thread pool as soon as their
+// first import is parsed, every module with its own arena and diagnostics.
+// The pool is only started by the first import, so a program without any
+// runs on the calling thread alone.
+// Once all are loaded they are ordered, and their diagnostics merged,
+// depth-first in import order, so the result does not depend on scheduling:
+// every module comes after its imports and import cycles are reported.
+class [[nodiscard]] ModuleGraph
+{
+  public:
+    using ModuleId = std::size_t;
+
+    // The graph owns the whole AST, it has to outlive every use of the
+    // modules returned by build(). Imports load on up to `thread_count`
+    // threads.
+    ModuleGraph(const std::shared_ptr<Supervisor>& supervisor, std::size_t thread_count);
+
+    // Parses the root module from its tokens and everything it transitively
+    // imports
+    [[nodiscard]] std::vector<ModuleStatement*> build(std::span<const Token> root_tokens) noexcept;
+
+    // Called by the parser of `importer` for each of its imports, `position`
+    // is where the import is spelled. Safe to call from several threads.
+    void import(ModuleId importer, const std::filesystem::path& path, Position position) noexcept;
+
+  private:
+    struct Import
+    {
+        ModuleId module;
+        Position position;
+    };
+
+    struct Module
+    {
+        explicit Module(std::filesystem::path module_path, std::shared_ptr<Supervisor> module_supervisor)
+            : path{std::move(module_path)},
+              supervisor{std::move(module_supervisor)}
+        {
+        }
+
+        std::filesystem::path         path;
+        std::shared_ptr<Supervisor>   supervisor;
+        Arena                         arena;
+        std::vector<Import>           imports;
+        std::vector<ModuleStatement*> statements;
+        bool                          found = true;
+    };
+
+    enum class State : std::uint8_t
+    {
+        UNVISITED,
+        IN_PROGRESS,
+        DONE,
+    };
+
+    [[nodiscard]] Module& module(ModuleId id) noexcept;
+
+    void load(ModuleId id) noexcept;
+
+    void parse(ModuleId id, std::span<const Token> tokens) noexcept;
+
+    void order(
+        ModuleId                       id,
+        std::vector<State>&            states,
+        std::vector<ModuleId>&         import_stack,
+        std::vector<ModuleStatement*>& ordered) noexcept;
+
+    [[nodiscard]] std::string cycle_description(
+        const std::vector<ModuleId>& import_stack, ModuleId repeated) const;
+
+    std::shared_ptr<Supervisor>               m_supervisor;
+    std::mutex                                m_mutex;
+    std::deque<Module>                        m_modules;
+    std::unordered_map<std::string, ModuleId> m_module_ids;
+    std::size_t                               m_thread_count;
+
+    // Last, so pending loads finish before the modules they fill go away.
+    // Started under m_mutex by the first import.
+    std::optional<ThreadPool> m_pool;
+};
@@ -1,6 +1,6 @@
 #include "Parser.hpp"
 
-#include <dtsutil/filesystem.hpp>
+#include <array>
 
 #define ASSERT_OR_ERROR(condition, message, position) \
     if (!(condition)) {                               \
@@ -14,22 +14,89 @@
         return nullptr;                                        \
     }
 
-std::vector<ModuleStatement>
-Parser::parse(std::vector<Token> tokens, const std::shared_ptr<Supervisor>& supervisor) noexcept
+namespace
 {
-    Parser parser(std::move(tokens), supervisor);
+
+// How tightly every token binds as an infix operator, NONE for tokens that
+// are not one
+constexpr auto infix_precedences = [] {
+    std::array<Parser::Precedence, static_cast<std::size_t>(Token::Type::MAX)> precedences{};
+    precedences.fill(Parser::Precedence::NONE);
+
+    const auto set = [&precedences](const Token::Type type, const Parser::Precedence precedence) {
+        precedences[static_cast<std::size_t>(type)] = precedence;
+    };
+
+    set(Token::Type::EQUAL, Parser::Precedence::ASSIGNMENT);
+    set(Token::Type::PLUS_EQUAL, Parser::Precedence::ASSIGNMENT);
+    set(Token::Type::OR, Parser::Precedence::LOGICAL_OR);
+    set(Token::Type::AND, Parser::Precedence::LOGICAL_AND);
+    set(Token::Type::EQUAL_EQUAL, Parser::Precedence::EQUALITY);
+    set(Token::Type::BANG_EQUAL, Parser::Precedence::EQUALITY);
+    set(Token::Type::GREATER, Parser::Precedence::COMPARISON);
+    set(Token::Type::GREATER_EQUAL, Parser::Precedence::COMPARISON);
+    set(Token::Type::LESS, Parser::Precedence::COMPARISON);
+    set(Token::Type::LESS_EQUAL, Parser::Precedence::COMPARISON);
+    set(Token::Type::PLUS, Parser::Precedence::TERM);
+    set(Token::Type::MINUS, Parser::Precedence::TERM);
+    set(Token::Type::STAR, Parser::Precedence::FACTOR);
+    set(Token::Type::SLASH, Parser::Precedence::FACTOR);
+    set(Token::Type::LEFT_BRACKET, Parser::Precedence::INDEX);
+    set(Token::Type::DOT, Parser::Precedence::FIELD_ACCESS);
+    set(Token::Type::ARROW, Parser::Precedence::FIELD_ACCESS);
+    set(Token::Type::COLON_COLON, Parser::Precedence::FIELD_ACCESS);
+
+    return precedences;
+}();
+
+// Left associative operators parse their right operand one level tighter
+[[nodiscard]] constexpr Parser::Precedence tighter(const Parser::Precedence precedence) noexcept
+{
+    return static_cast<Parser::Precedence>(static_cast<std::uint8_t>(precedence) + 1);
+}
+
+[[nodiscard]] std::string binary_operator_error(const Token& binary_operator)
+{
+    if (Token::is_equality_operator(binary_operator)) {
+        return "expected expression after equality operator while parsing";
+    }
+    if (Token::is_comparison_operator(binary_operator)) {
+        return "expected expression after comparison operator while parsing";
+    }
+    return fmt::format(
+        "expected expression after '{}' arithmetic operator while parsing", binary_operator.lexeme());
+}
+
+} // namespace
+
+std::vector<ModuleStatement*> Parser::parse(
+    std::span<const Token>             tokens,
+    const std::shared_ptr<Supervisor>& supervisor,
+    Arena&                             arena,
+    ModuleGraph&                       module_graph,
+    const ModuleGraph::ModuleId        module_id) noexcept
+{
+    Parser parser(tokens, supervisor, arena, module_graph, module_id);
     return parser.parse_project();
 }
 
-Parser::Parser(std::vector<Token>&& tokens, const std::shared_ptr<Supervisor>& supervisor) noexcept
+Parser::Parser(
+    std::span<const Token>             tokens,
+    const std::shared_ptr<Supervisor>& supervisor,
+    Arena&                             arena,
+    ModuleGraph&                       module_graph,
+    const ModuleGraph::ModuleId        module_id) noexcept
     : Iterator(tokens),
-      m_supervisor{supervisor}
+      m_supervisor{supervisor},
+      m_arena{arena},
+      m_module_graph{module_graph},
+      m_module_id{module_id}
 {
 }
 
-std::vector<ModuleStatement> Parser::parse_project() noexcept
+std::vector<ModuleStatement*> Parser::parse_project() noexcept
 {
-    std::vector<ModuleStatement> modules;
+    std::vector<ModuleStatement*> modules;
 
     while (!eof() && !m_supervisor->has_errors()) {
         if (eol()) {
@@ -41,38 +108,27 @@ std::vector<ModuleStatement> Parser::parse_project() noexcept
             advance(1); // Skip the import token
 
             const auto import_module = fmt::format("{}.dl", next()->lexeme());
-            const auto import_module_path =
-                m_supervisor->project_root().parent_path() / import_module;
-
-            const auto module_content = dts::read_file(import_module_path.string());
-            if (!module_content) {
-                m_supervisor->push_error(
-                    fmt::format("Could not import module: {}", import_module),
-                    previous_position());
-                return {};
-            }
-
-            const auto lexed_tokens = Lexer::lex(*module_content, m_supervisor);
-
-            const auto imported_modules = Parser::parse(lexed_tokens, m_supervisor);
-            modules.insert(
-                modules.end(), imported_modules.begin(), imported_modules.end());
+            m_module_graph.import(
+                m_module_id,
+                m_supervisor->project_root().parent_path() / import_module,
+                previous_position());
+            continue;
         }
 
-        modules.push_back(*parse_module()->as<ModuleStatement>());
+        modules.push_back(parse_module()->as<ModuleStatement>());
     }
 
     return modules;
 }
 
-std::shared_ptr<Statement> Parser::parse_module() noexcept
+Statement* Parser::parse_module() noexcept
 {
     std::string name = "main";
 
     std::vector<std::string>                c_includes;
-    std::vector<std::shared_ptr<Statement>> structs;
-    std::vector<std::shared_ptr<Statement>> enums;
-    std::vector<std::shared_ptr<Statement>> functions;
+    std::vector<Statement*> structs;
+    std::vector<Statement*> enums;
+    std::vector<Statement*> functions;
 
     while (!eof() && !m_supervisor->has_errors()) {
         if (eol()) {
@@ -94,14 +150,14 @@ std::shared_ptr<Statement> Parser::parse_module() noexcept
         }
     }
 
-    return std::make_shared<ModuleStatement>(
+    return m_arena.create<ModuleStatement>(
         name, c_includes, BlockStatement(structs), BlockStatement(enums), BlockStatement(functions));
 }
 
-std::shared_ptr<Statement> Parser::parse_function_statement() noexcept
+Statement* Parser::parse_function_statement() noexcept
 {
-    // Setup the new environment
-    m_current_environment = std::make_unique<Environment>();
+    // Every function starts from an empty environment
+    m_environment.clear();
 
     // Skip the fn token
     const auto fn_token = next();
@@ -149,11 +205,11 @@ std::shared_ptr<Statement> Parser::parse_function_statement() noexcept
     const auto body = parse_statement_block();
     MATCHES_OR_ERROR(Token::Type::RIGHT_BRACE, "expected '}' after function body while parsing")
 
-    return std::make_shared<FunctionStatement>(
-        FunctionStatement(name->lexeme(), args, return_type, BlockStatement(body)));
+    return m_arena.create<FunctionStatement>(
+        std::string(name->lexeme()), args, return_type, BlockStatement(body));
 }
 
-std::shared_ptr<Statement> Parser::parse_statement()
+Statement* Parser::parse_statement()
 {
     switch (peek()->type()) {
         case Token::Type::IF: {
@@ -180,7 +236,7 @@ std::shared_ptr<Statement> Parser::parse_statement()
         }
         case Token::Type::END_OF_LINE: {
             advance(1);
-            return std::make_shared<EmptyStatement>();
+            return m_arena.create<EmptyStatement>();
         }
         default: {
             return parse_expression_statement();
@@ -188,7 +244,7 @@ std::shared_ptr<Statement> Parser::parse_statement()
     }
 }
 
-std::shared_ptr<Statement> Parser::parse_if_statement()
+Statement* Parser::parse_if_statement()
 {
     // Skip the if token
     const auto if_token = next();
@@ -215,8 +271,8 @@ std::shared_ptr<Statement> Parser::parse_if_statement()
 
     // Parse else block
     if (const auto else_token = peek(); !else_token || else_token->lexeme() != "else") {
-        return std::make_shared<IfStatement>(
-            IfStatement(condition, BlockStatement(then_block), BlockStatement({})));
+        return m_arena.create<IfStatement>(
+            condition, BlockStatement(then_block), BlockStatement({}));
     }
 
     advance(1); // Skip the else token
@@ -225,11 +281,11 @@ std::shared_ptr<Statement> Parser::parse_if_statement()
     const auto else_block = parse_statement_block();
     MATCHES_OR_ERROR(Token::Type::RIGHT_BRACE, "expected '}' after if statement's 'else branch' while parsing")
 
-    return std::make_shared<IfStatement>(IfStatement(
-        condition, BlockStatement(then_block), BlockStatement(else_block)));
+    return m_arena.create<IfStatement>(
+        condition, BlockStatement(then_block), BlockStatement(else_block));
 }
 
-std::shared_ptr<Statement> Parser::parse_return_statement()
+Statement* Parser::parse_return_statement()
 {
     // Skip the return token
     const auto return_token = next();
@@ -241,14 +297,14 @@ std::shared_ptr<Statement> Parser::parse_return_statement()
         "expected expression after return keyword while parsing",
         return_token->position())
 
-    return std::make_shared<ReturnStatement>(ReturnStatement(expression));
+    return m_arena.create<ReturnStatement>(expression);
 }
 
-std::shared_ptr<Statement> Parser::parse_variable_statement(const Token::Type& ending_delimiter)
+Statement* Parser::parse_variable_statement(const Token::Type& ending_delimiter)
 {
     if (!Typechecker::is_valid_type(peek()->lexeme(), m_custom_types) &&
         !peek()->matches(Token::Type::MUT)) {
-        return std::make_shared<ExpressionStatement>(parse_assignment_expression());
+        return m_arena.create<ExpressionStatement>(parse_expression());
     }
 
     const auto variable_declaration = parse_variable_declaration();
@@ -268,13 +324,12 @@ std::shared_ptr<Statement> Parser::parse_variable_statement(const Token::Type& e
 
     MATCHES_OR_ERROR(ending_delimiter, "expected ';' or newline after expression in variable declaration while parsing")
 
-    m_current_environment->enscope(variable_declaration);
+    m_environment.enscope(variable_declaration);
 
-    return std::make_shared<VariableStatement>(
-        VariableStatement(variable_declaration, expression));
+    return m_arena.create<VariableStatement>(variable_declaration, expression);
 }
 
-std::shared_ptr<Statement> Parser::parse_while_statement()
+Statement* Parser::parse_while_statement()
 {
     // Skip the while token and the left paren
     const auto while_token = next();
@@ -300,10 +355,10 @@ std::shared_ptr<Statement> Parser::parse_while_statement()
 
     MATCHES_OR_ERROR(Token::Type::RIGHT_BRACE, "expected '}' after while-loop body while parsing")
 
-    return std::make_shared<WhileStatement>(WhileStatement(condition, BlockStatement(body)));
+    return m_arena.create<WhileStatement>(condition, BlockStatement(body));
 }
 
-std::shared_ptr<Statement> Parser::parse_for_statement()
+Statement* Parser::parse_for_statement()
 {
     // Skip the for token and the left paren
     const auto for_token = next();
@@ -346,25 +401,25 @@ std::shared_ptr<Statement> Parser::parse_for_statement()
     // Skip the right brace
     MATCHES_OR_ERROR(Token::Type::RIGHT_BRACE, "expected '}' after for-loop body while parsing")
 
-    return std::make_shared<ForStatement>(
-        ForStatement(initializer, condition, increment, BlockStatement(body)));
+    return m_arena.create<ForStatement>(
+        initializer, condition, increment, BlockStatement(body));
 }
 
-std::shared_ptr<Statement> Parser::parse_expression_statement()
+Statement* Parser::parse_expression_statement()
 {
     const auto expression = parse_expression();
     ASSERT_OR_ERROR(expression, "expected expression while parsing expression statement", previous_position())
     skip_newlines();
-    return std::make_shared<ExpressionStatement>(ExpressionStatement(expression));
+    return m_arena.create<ExpressionStatement>(expression);
 }
 
-std::shared_ptr<Statement> Parser::parse_array_statement(const Typechecker::VariableDeclaration& variable_declaration)
+Statement* Parser::parse_array_statement(const Typechecker::VariableDeclaration& variable_declaration)
 {
     MATCHES_OR_ERROR(Token::Type::EQUAL, "expected '=' after array declaration while parsing")
 
     MATCHES_OR_ERROR(Token::Type::LEFT_BRACKET, "expected '[' after array declaration while parsing")
 
-    std::vector<std::shared_ptr<Expression>> array_elements;
+    std::vector<Expression*> array_elements;
     consume_tokens_until(Token::Type::RIGHT_BRACKET, [this, &array_elements] {
         if (peek()->matches(Token::Type::COMMA)) { advance(1); }
         const auto expression = parse_expression();
@@ -376,7 +431,7 @@ std::shared_ptr<Statement> Parser::parse_array_statement(const Typechecker::Vari
 
     skip_newlines();
 
-    return std::make_shared<ArrayStatement>(ArrayStatement(variable_declaration, array_elements));
+    return m_arena.create<ArrayStatement>(variable_declaration, std::move(array_elements));
 }
 
 std::string Parser::parse_c_include_statement()
@@ -390,12 +445,12 @@ std::string Parser::parse_c_include_statement()
         return "";
     }
 
-    return path->lexeme();
+    return std::string(path->lexeme());
 }
 
-std::shared_ptr<Statement> Parser::parse_struct_statement() noexcept
+Statement* Parser::parse_struct_statement() noexcept
 {
-    const auto struct_token = next();
+    advance(1); // Skip the struct token
 
     const auto struct_name = parse_identifier();
     if (struct_name.empty()) { return nullptr; }
@@ -411,15 +466,15 @@ std::shared_ptr<Statement> Parser::parse_struct_statement() noexcept
 
     skip_newlines();
 
-    const auto struct_statement =
-        std::make_shared<StructStatement>(StructStatement(struct_name, member_variables));
+    const auto struct_statement = m_arena.create<StructStatement>(struct_name, member_variables);
 
-    m_custom_types.emplace(Typechecker::CustomType(struct_name, Token::Type::STRUCT), struct_statement);
+    m_custom_types.add(
+        Typechecker::CustomType(Symbol::intern(struct_name), Token::Type::STRUCT), struct_statement);
 
     return struct_statement;
 }
 
-std::shared_ptr<Statement> Parser::parse_enum_statement() noexcept
+Statement* Parser::parse_enum_statement() noexcept
 {
     const auto enum_token = next();
 
@@ -439,15 +494,15 @@ std::shared_ptr<Statement> Parser::parse_enum_statement() noexcept
 
     skip_newlines();
 
-    const auto enum_statement =
-        std::make_shared<EnumStatement>(EnumStatement(enum_name, enum_variants));
+    const auto enum_statement = m_arena.create<EnumStatement>(enum_name, enum_variants);
 
-    m_custom_types.emplace(Typechecker::CustomType(enum_name, Token::Type::ENUM), enum_statement);
+    m_custom_types.add(
+        Typechecker::CustomType(Symbol::intern(enum_name), Token::Type::ENUM), enum_statement);
 
     return enum_statement;
 }
 
-std::shared_ptr<Statement> Parser::parse_match_statement() noexcept
+Statement* Parser::parse_match_statement() noexcept
 {
     const auto match_token = next();
 
@@ -512,7 +567,7 @@ std::shared_ptr<Statement> Parser::parse_match_statement() noexcept
         skip_newlines();
 
         match_cases.emplace_back(
-            std::make_shared<EnumExpression>(*enum_expression),
+            enum_expression,
             destructuring,
             BlockStatement(body));
         destructuring.clear();
@@ -527,208 +582,135 @@ std::shared_ptr<Statement> Parser::parse_match_statement() noexcept
 
     skip_newlines();
 
-    return std::make_shared<MatchStatement>(MatchStatement(match_expression, match_cases));
-}
-
-std::shared_ptr<Expression> Parser::parse_expression()
-{
-    return parse_assignment_expression();
-}
-
-std::shared_ptr<Expression> Parser::parse_assignment_expression()
-{
-    auto expression = parse_logical_expression();
-
-    if (const auto assignment_operator = peek();
-        Token::is_assignment_operator(*assignment_operator)) {
-        advance(1); // Skip the assignment operator
-
-        auto value = parse_assignment_expression();
-        ASSERT_OR_ERROR(
-            value,
-            "expected expression after assignment operator while parsing",
-            assignment_operator->position())
-
-        if (Typechecker::is_valid_lvalue(expression)) {
-            return std::make_shared<AssignmentExpression>(AssignmentExpression(
-                expression, assignment_operator->type(), std::move(value)));
-        }
-
-
-        m_supervisor->push_error(
-            "expected variable on left side of assignment while parsing",
-            previous_position());
-    }
-
-    return expression;
+    return m_arena.create<MatchStatement>(match_expression, std::move(match_cases));
 }
 
-std::shared_ptr<Expression> Parser::parse_logical_expression()
+Expression* Parser::parse_expression(const Precedence min_precedence)
 {
-    auto expression = parse_equality_expression();
-
-    auto logical_operator = peek();
-    while (Token::is_logical_operator(*logical_operator)) {
-        advance(1); // Skip the logical operator
-
-        auto right = parse_equality_expression();
-        ASSERT_OR_ERROR(
-            right,
-            fmt::format(
-                "expected expression after logical operator while parsing",
-                logical_operator->lexeme()),
-            logical_operator->position())
-
-        expression = std::make_shared<LogicalExpression>(LogicalExpression(
-            std::move(expression), logical_operator->type(), std::move(right)));
-        logical_operator = peek();
-    }
-
-    return expression;
-}
-
-std::shared_ptr<Expression> Parser::parse_equality_expression()
-{
-    auto expression = parse_comparison_expression();
-
-    auto equality_operator = peek();
-    while (Token::is_equality_operator(*equality_operator)) {
-        advance(1);
-        auto right = parse_comparison_expression();
-        ASSERT_OR_ERROR(
-            right,
-            "expected expression after equality operator while parsing",
-            equality_operator->position())
-
-        expression        = std::make_shared<BinaryExpression>(BinaryExpression(
-            std::move(expression), equality_operator->type(), std::move(right)));
-        equality_operator = peek();
-    }
-
-    return expression;
-}
-
-std::shared_ptr<Expression> Parser::parse_comparison_expression()
-{
-    auto expression = parse_arithmetic_operator_expression();
-
-    auto comparison_operator = peek();
-    while (Token::is_comparison_operator(*comparison_operator)) {
-        advance(1);
-        auto right = parse_arithmetic_operator_expression();
-        ASSERT_OR_ERROR(
-            right,
-            "expected expression after comparison operator while parsing",
-            comparison_operator->position())
-
-        expression = std::make_shared<BinaryExpression>(BinaryExpression(
-            std::move(expression), comparison_operator->type(), std::move(right)));
-        comparison_operator = peek();
-    }
-
-    return expression;
-}
-
-std::shared_ptr<Expression> Parser::parse_arithmetic_operator_expression()
-{
-    auto expression = parse_index_operator_expression();
-
-    auto arithmetic_operator = peek();
-    while (Token::is_arithmetic_operator(*arithmetic_operator)) {
-        advance(1); // Skip the arithmetic operator
-
-        auto right = parse_index_operator_expression();
-        ASSERT_OR_ERROR(
-            right,
-            fmt::format(
-                "expected expression after '{}' arithmetic operator while "
-                "parsing",
-                arithmetic_operator->lexeme()),
-            arithmetic_operator->position())
-
-        expression = std::make_shared<BinaryExpression>(BinaryExpression(
-            std::move(expression), arithmetic_operator->type(), std::move(right)));
-        arithmetic_operator = peek();
-    }
-
-    return expression;
-}
-
-std::shared_ptr<Expression> Parser::parse_index_operator_expression()
-{
-    auto expression = parse_field_accessors_expression();
-
-    while (matches_and_consume(Token::Type::LEFT_BRACKET)) {
-        auto index = parse_expression();
-        ASSERT_OR_ERROR(index, "expected expression inside index operator while parsing", previous_position())
-
-        MATCHES_OR_ERROR(Token::Type::RIGHT_BRACKET, "expected ']' after index operator while parsing")
+    auto expression = parse_unary_expression();
+    if (expression == nullptr) { return nullptr; }
+
+    // Operators binding at least as tightly as `min_precedence` are folded
+    // into the expression, each one parsing its right operand with its own
+    // precedence as the new minimum
+    for (auto infix_operator = peek(); infix_operator; infix_operator = peek()) {
+        const auto precedence = infix_precedences[static_cast<std::size_t>(infix_operator->type())];
+        if (precedence == Precedence::NONE || precedence < min_precedence) { break; }
+
+        advance(1); // Skip the operator
+
+        switch (precedence) {
+            case Precedence::ASSIGNMENT: {
+                // Right associative, so the value takes the rest of the expression
+                auto value = parse_expression(Precedence::ASSIGNMENT);
+                ASSERT_OR_ERROR(
+                    value,
+                    "expected expression after assignment operator while parsing",
+                    infix_operator->position())
+
+                if (!Typechecker::is_valid_lvalue(expression)) {
+                    m_supervisor->push_error(
+                        "expected variable on left side of assignment while parsing",
+                        previous_position());
+                    return expression;
+                }
 
-        expression = std::make_shared<IndexOperatorExpression>(
-            IndexOperatorExpression(std::move(expression), std::move(index)));
-    }
+                expression = m_arena.create<AssignmentExpression>(
+                    expression, infix_operator->type(), value, infix_operator->position());
+                break;
+            }
+            case Precedence::LOGICAL_OR:
+            case Precedence::LOGICAL_AND: {
+                auto right = parse_expression(tighter(precedence));
+                ASSERT_OR_ERROR(
+                    right,
+                    "expected expression after logical operator while parsing",
+                    infix_operator->position())
+
+                expression = m_arena.create<LogicalExpression>(
+                    expression, infix_operator->type(), right, infix_operator->position());
+                break;
+            }
+            case Precedence::EQUALITY:
+            case Precedence::COMPARISON:
+            case Precedence::TERM:
+            case Precedence::FACTOR: {
+                auto right = parse_expression(tighter(precedence));
+                ASSERT_OR_ERROR(right, binary_operator_error(*infix_operator), infix_operator->position())
+
+                expression = m_arena.create<BinaryExpression>(
+                    expression, infix_operator->type(), right, infix_operator->position());
+                break;
+            }
+            case Precedence::INDEX: {
+                auto index = parse_expression();
+                ASSERT_OR_ERROR(index, "expected expression inside index operator while parsing", previous_position())
 
-    return expression;
-}
+                MATCHES_OR_ERROR(Token::Type::RIGHT_BRACKET, "expected ']' after index operator while parsing")
 
-std::shared_ptr<Expression> Parser::parse_field_accessors_expression()
-{
-    auto expression = parse_unary_expression();
+                expression = m_arena.create<IndexOperatorExpression>(
+                    expression, index, infix_operator->position());
+                break;
+            }
+            case Precedence::FIELD_ACCESS: {
+                // Nothing binds tighter, the right side is a single operand
+                auto right = parse_unary_expression();
+                ASSERT_OR_ERROR(
+                    right,
+                    fmt::format(
+                        "expected expression after '{}' while parsing", infix_operator->lexeme()),
+                    infix_operator->position())
+
+                // Check if it is an enum accessor
+                const auto* custom_type = m_custom_types.find(expression->evaluate());
+                if (custom_type != nullptr && custom_type->type.type == Token::Type::ENUM) {
+                    expression = m_arena.create<EnumExpression>(
+                        expression, right, infix_operator->position());
+                    break;
+                }
 
-    auto field_accessor = peek();
-    while (Token::is_field_accessor(*field_accessor)) {
-        advance(1);
-        auto right = parse_unary_expression();
-        ASSERT_OR_ERROR(
-            right,
-            fmt::format(
-                "expected expression after '{}' while parsing", field_accessor->lexeme()),
-            field_accessor->position())
-
-        // Check if it is an enum accessor
-        const auto custom_type_name = expression->evaluate();
-        const auto custom_type_key =
-            Typechecker::CustomType(custom_type_name, Token::Type::ENUM);
-
-        if (m_custom_types.contains(custom_type_key)) {
-            expression = std::make_shared<EnumExpression>(
-                EnumExpression(std::move(expression), std::move(right)));
-            field_accessor = peek();
-            continue;
+                expression = m_arena.create<BinaryExpression>(
+                    expression, infix_operator->type(), right, infix_operator->position());
+                break;
+            }
+            case Precedence::NONE: {
+                break;
+            }
         }
-
-        expression     = std::make_shared<BinaryExpression>(BinaryExpression(
-            std::move(expression), field_accessor->type(), std::move(right)));
-        field_accessor = peek();
     }
 
     return expression;
 }
 
-std::shared_ptr<Expression> Parser::parse_unary_expression()
+Expression* Parser::parse_unary_expression()
 {
     if (const auto unary_operator = peek(); Token::is_unary_operator(*unary_operator)) {
         advance(1); // consume the operator
-        auto right = parse_unary_expression();
+
+        // Indexing and field accesses bind to the operand first, so `&s.x`
+        // takes the address of the field rather than accessing `(&s).x`
+        auto right = parse_expression(Precedence::INDEX);
         ASSERT_OR_ERROR(
             right,
             "expected expression after unary operator while parsing",
             unary_operator->position())
 
-        return std::make_shared<UnaryExpression>(
-            UnaryExpression(unary_operator->type(), std::move(right)));
+        return m_arena.create<UnaryExpression>(
+            unary_operator->type(), right, unary_operator->position());
     }
 
     return parse_function_call_expression();
 }
 
-std::shared_ptr<Expression> Parser::parse_function_call_expression()
+Expression* Parser::parse_function_call_expression()
 {
     auto identifier = parse_primary_expression();
 
-    if (!matches_and_consume(Token::Type::LEFT_PAREN)) { return identifier; }
+    if (identifier == nullptr || !matches_and_consume(Token::Type::LEFT_PAREN)) {
+        return identifier;
+    }
 
-    std::vector<std::shared_ptr<Expression>> arguments;
+    std::vector<Expression*> arguments;
     consume_tokens_until(Token::Type::RIGHT_PAREN, [this, &arguments] {
         if (peek()->matches(Token::Type::COMMA)) { advance(1); }
         arguments.push_back(parse_expression());
@@ -736,30 +718,28 @@ std::shared_ptr<Expression> Parser::parse_function_call_expression()
 
     MATCHES_OR_ERROR(Token::Type::RIGHT_PAREN, "expected ')' after function call while parsing")
 
-    return std::make_shared<FunctionCallExpression>(
-        FunctionCallExpression(identifier, arguments));
+    return m_arena.create<FunctionCallExpression>(
+        identifier, std::move(arguments), identifier->position());
 }
 
-std::shared_ptr<Expression> Parser::parse_primary_expression()
+Expression* Parser::parse_primary_expression()
 {
     const auto current_token = next();
 
-    if (Token::is_literal(*current_token)) {
-        return std::make_shared<LiteralExpression>(current_token->lexeme());
-    }
-
-    if (Token::is_boolean(*current_token)) {
-        return std::make_shared<LiteralExpression>(current_token->lexeme());
+    if (Token::is_literal(*current_token) || Token::is_boolean(*current_token)) {
+        return m_arena.create<LiteralExpression>(
+            current_token->type(), std::string(current_token->lexeme()), current_token->position());
     }
 
     if (current_token->matches(Token::Type::IDENTIFIER)) {
-        return std::make_shared<VariableExpression>(current_token->lexeme());
+        return m_arena.create<VariableExpression>(
+            Symbol::intern(current_token->lexeme()), current_token->position());
     }
 
     if (current_token->matches(Token::Type::LEFT_PAREN)) {
         auto expression = parse_expression();
         MATCHES_OR_ERROR(Token::Type::RIGHT_PAREN, "expected ')' after expression while parsing")
-        return std::make_shared<GroupingExpression>(std::move(expression));
+        return m_arena.create<GroupingExpression>(expression, current_token->position());
     }
 
     m_supervisor->push_error(
@@ -768,16 +748,16 @@ std::shared_ptr<Expression> Parser::parse_primary_expression()
     return nullptr;
 }
 
-std::vector<std::shared_ptr<Statement>> Parser::parse_statement_block() noexcept
+std::vector<Statement*> Parser::parse_statement_block() noexcept
 {
-    m_current_environment = std::make_shared<Environment>(m_current_environment);
+    m_environment.enter_scope();
 
-    std::vector<std::shared_ptr<Statement>> block;
+    std::vector<Statement*> block;
     consume_tokens_until(Token::Type::RIGHT_BRACE, [this, &block] {
         block.push_back(parse_statement());
     });
 
-    m_current_environment = m_current_environment->parent();
+    m_environment.exit_scope();
 
     return block;
 }
@@ -794,7 +774,7 @@ std::string Parser::parse_identifier() noexcept
         return "";
     }
 
-    return identifier->lexeme();
+    return std::string(identifier->lexeme());
 }
 
 std::vector<Typechecker::VariableDeclaration> Parser::parse_member_variables() noexcept
@@ -815,8 +795,7 @@ Typechecker::VariableDeclaration Parser::parse_variable_declaration() noexcept
     if (is_mutable) { advance(1); }
 
     auto variable_type = Typechecker::builtin_type_from_string(peek()->lexeme());
-    std::optional<Typechecker::CustomType> custom_type =
-        defined_custom_type(peek()->lexeme());
+    const auto* custom_type = defined_custom_type(peek()->lexeme());
 
     if (variable_type == Typechecker::BuiltinType::NONE && !custom_type) {
         m_supervisor->push_error(
@@ -837,7 +816,7 @@ Typechecker::VariableDeclaration Parser::parse_variable_declaration() noexcept
         type_extensions.append(next()->lexeme());
     });
 
-    const std::string variable_name = parse_identifier();
+    const auto variable_name = Symbol::intern(parse_identifier());
 
     skip_newlines();
 
@@ -896,7 +875,7 @@ EnumStatement::EnumVariant Parser::parse_enum_variants() noexcept
 
         skip_newlines();
 
-        variants.emplace(variant_name, fields);
+        variants.emplace(Symbol::intern(variant_name), fields);
     });
 
     return variants;
@@ -918,7 +897,7 @@ void Parser::consume_tokens_until(const Token::Type& delimiter, Callable&& calla
 
 bool Parser::matches_and_consume(const Token::Type& delimiter) noexcept
 {
-    if (const auto token = peek(); !peek() || !peek()->matches(delimiter)) {
+    if (const auto token = peek(); !token || !token->matches(delimiter)) {
         return false;
     }
 
@@ -944,13 +923,8 @@ bool Parser::identifier_is_function_call() const noexcept
     return true;
 }
 
-std::optional<Typechecker::CustomType> Parser::defined_custom_type(const std::string token) const noexcept
+const Typechecker::CustomType* Parser::defined_custom_type(const std::string_view token) const noexcept
 {
-    const auto found = std::ranges::find_if(m_custom_types, [&token](const auto map_entry) {
-        const auto [custom_type, statement] = map_entry;
-        return custom_type.name == token;
-    });
-
-    if (found != m_custom_types.end()) { return found->first; }
-    return {};
+    const auto* entry = m_custom_types.find(token);
+    return entry != nullptr ? &entry->type : nullptr;
 }
@@ -2,8 +2,10 @@
 
 #include <algorithm>
 #include <concepts>
+#include <cstdint>
 #include <memory>
 #include <optional>
+#include <span>
 #include <unordered_map>
 #include <vector>
 
@@ -11,6 +13,7 @@
 
 #include <fmt/core.h>
 
+#include "Arena.hpp"
 #include "Environment.hpp"
 #include "Expression.hpp"
 #include "Iterator.hpp"
@@ -18,67 +21,77 @@
 #include "Statement.hpp"
 #include "Supervisor.hpp"
 #include "Token.hpp"
+#include "TypeRegistry.hpp"
 #include "Typechecker.hpp"
 
-namespace std
-{
-template <>
-struct hash<Typechecker::CustomType>
-{
-    std::size_t operator()(const Typechecker::CustomType& custom_type) const noexcept
-    {
-        return std::hash<std::string>{}(custom_type.name);
-    }
-};
-} // namespace std
+#include "ModuleGraph.hpp"
 
-class [[nodiscard]] Parser : public Iterator<std::vector<Token>>
+class [[nodiscard]] Parser : public Iterator<std::span<const Token>>
 {
   public:
-    [[nodiscard]] static std::vector<ModuleStatement>
-    parse(std::vector<Token> tokens, const std::shared_ptr<Supervisor>& supervisor) noexcept;
+    // Binding power of the infix operators, loosest first. Operators of the
+    // same level associate to the left, except for assignments. The levels
+    // follow C's so the tree groups operands the way the emitted C++ does.
+    enum class Precedence : std::uint8_t
+    {
+        NONE,
+        ASSIGNMENT,
+        LOGICAL_OR,
+        LOGICAL_AND,
+        EQUALITY,
+        COMPARISON,
+        TERM,
+        FACTOR,
+        INDEX,
+        FIELD_ACCESS,
+    };
+
+    // Every node of the resulting tree is owned by `arena`, imports are
+    // handed to `module_graph` on behalf of module `module_id`
+    [[nodiscard]] static std::vector<ModuleStatement*> parse(
+        std::span<const Token>             tokens,
+        const std::shared_ptr<Supervisor>& supervisor,
+        Arena&                             arena,
+        ModuleGraph&                       module_graph,
+        ModuleGraph::ModuleId              module_id) noexcept;
 
   private:
-    explicit Parser(std::vector<Token>&& tokens, const std::shared_ptr<Supervisor>& supervisor) noexcept;
+    explicit Parser(
+        std::span<const Token>             tokens,
+        const std::shared_ptr<Supervisor>& supervisor,
+        Arena&                             arena,
+        ModuleGraph&                       module_graph,
+        ModuleGraph::ModuleId              module_id) noexcept;
 
     // Project
-    [[nodiscard]] std::vector<ModuleStatement> parse_project() noexcept;
+    [[nodiscard]] std::vector<ModuleStatement*> parse_project() noexcept;
 
     // Statements
-    [[nodiscard]] std::shared_ptr<Statement> parse_module() noexcept;
-    [[nodiscard]] std::shared_ptr<Statement> parse_function_statement() noexcept;
-    [[nodiscard]] std::shared_ptr<Statement> parse_statement();
-    [[nodiscard]] std::shared_ptr<Statement> parse_if_statement();
-    [[nodiscard]] std::shared_ptr<Statement> parse_return_statement();
-    [[nodiscard]] std::shared_ptr<Statement>
-                                             parse_variable_statement(const Token::Type& ending_delimiter = Token::Type::END_OF_LINE);
-    [[nodiscard]] std::shared_ptr<Statement> parse_while_statement();
-    [[nodiscard]] std::shared_ptr<Statement> parse_for_statement();
-    [[nodiscard]] std::shared_ptr<Statement> parse_expression_statement();
-    [[nodiscard]] std::shared_ptr<Statement>
-                                             parse_array_statement(const Typechecker::VariableDeclaration& variable_declaration);
-    [[nodiscard]] std::string                parse_c_include_statement();
-    [[nodiscard]] std::shared_ptr<Statement> parse_struct_statement() noexcept;
-    [[nodiscard]] std::shared_ptr<Statement> parse_enum_statement() noexcept;
-    [[nodiscard]] std::shared_ptr<Statement> parse_match_statement() noexcept;
-    [[nodiscard]] std::shared_ptr<Statement> parse_import_statement() noexcept;
+    [[nodiscard]] Statement*  parse_module() noexcept;
+    [[nodiscard]] Statement*  parse_function_statement() noexcept;
+    [[nodiscard]] Statement*  parse_statement();
+    [[nodiscard]] Statement*  parse_if_statement();
+    [[nodiscard]] Statement*  parse_return_statement();
+    [[nodiscard]] Statement*  parse_variable_statement(const Token::Type& ending_delimiter = Token::Type::END_OF_LINE);
+    [[nodiscard]] Statement*  parse_while_statement();
+    [[nodiscard]] Statement*  parse_for_statement();
+    [[nodiscard]] Statement*  parse_expression_statement();
+    [[nodiscard]] Statement*  parse_array_statement(const Typechecker::VariableDeclaration& variable_declaration);
+    [[nodiscard]] std::string parse_c_include_statement();
+    [[nodiscard]] Statement*  parse_struct_statement() noexcept;
+    [[nodiscard]] Statement*  parse_enum_statement() noexcept;
+    [[nodiscard]] Statement*  parse_match_statement() noexcept;
+    [[nodiscard]] Statement*  parse_import_statement() noexcept;
 
     // Expressions
-    [[nodiscard]] std::shared_ptr<Expression> parse_expression();
-    [[nodiscard]] std::shared_ptr<Expression> parse_assignment_expression();
-    [[nodiscard]] std::shared_ptr<Expression> parse_logical_expression();
-    [[nodiscard]] std::shared_ptr<Expression> parse_equality_expression();
-    [[nodiscard]] std::shared_ptr<Expression> parse_comparison_expression();
-    [[nodiscard]] std::shared_ptr<Expression> parse_arithmetic_operator_expression();
-    [[nodiscard]] std::shared_ptr<Expression> parse_index_operator_expression();
-    [[nodiscard]] std::shared_ptr<Expression> parse_field_accessors_expression();
-    [[nodiscard]] std::shared_ptr<Expression> parse_unary_expression();
-    [[nodiscard]] std::shared_ptr<Expression> parse_function_call_expression();
-    [[nodiscard]] std::shared_ptr<Expression> parse_primary_expression();
+    [[nodiscard]] Expression* parse_expression(Precedence min_precedence = Precedence::ASSIGNMENT);
+    [[nodiscard]] Expression* parse_unary_expression();
+    [[nodiscard]] Expression* parse_function_call_expression();
+    [[nodiscard]] Expression* parse_primary_expression();
 
 
     // Expression / Statement Utilities
-    [[nodiscard]] std::vector<std::shared_ptr<Statement>> parse_statement_block() noexcept;
+    [[nodiscard]] std::vector<Statement*> parse_statement_block() noexcept;
     [[nodiscard]] std::string parse_identifier() noexcept;
     [[nodiscard]] std::vector<Typechecker::VariableDeclaration> parse_member_variables() noexcept;
     [[nodiscard]] Typechecker::VariableDeclaration parse_variable_declaration() noexcept;
@@ -92,10 +105,13 @@ class [[nodiscard]] Parser : public Iterator<std::vector<Token>>
     [[nodiscard]] bool eol() const noexcept;
     void               skip_newlines() noexcept;
     [[nodiscard]] bool identifier_is_function_call() const noexcept;
-    [[nodiscard]] std::optional<Typechecker::CustomType>
-    defined_custom_type(const std::string token) const noexcept;
+    [[nodiscard]] const Typechecker::CustomType*
+    defined_custom_type(const std::string_view token) const noexcept;
 
     std::shared_ptr<Supervisor> m_supervisor;
-    std::unordered_map<Typechecker::CustomType, std::shared_ptr<Statement>> m_custom_types = {};
-    std::shared_ptr<Environment> m_current_environment = nullptr;
+    Arena&                      m_arena;
+    ModuleGraph&                m_module_graph;
+    ModuleGraph::ModuleId       m_module_id;
+    TypeRegistry                m_custom_types;
+    Environment                 m_environment;
 };
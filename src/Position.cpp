@@ -1,14 +1,22 @@
 #include "Position.hpp"
 
-Position Position::create(const std::size_t start, const std::size_t end) noexcept
+#include <algorithm>
+
+Position Position::create(const SourceId source, const std::size_t start, const std::size_t end) noexcept
 {
-    return {start, end};
+    // The lexer refuses sources past max_offset, clamping only guards against
+    // positions computed past the end of one
+    return {
+        source,
+        static_cast<std::uint32_t>(std::min(start, max_offset)),
+        static_cast<std::uint32_t>(std::min(end, max_offset))};
 }
 
-Position Position::create_dumb() noexcept { return {0, 0}; }
+Position Position::create_dumb() noexcept { return {0, 0, 0}; }
 
-Position::Position(const std::size_t start, const std::size_t end) noexcept
+Position::Position(const SourceId source, const std::uint32_t start, const std::uint32_t end) noexcept
     : m_start{start},
-      m_end{end}
+      m_end{end},
+      m_source{source}
 {
 }
@@ -1,13 +1,25 @@
 #pragma once
 
 #include <cstdint>
+#include <limits>
 
 #include <fmt/format.h>
 
+// A span of source text, [start, end) in bytes, and the source file it lies
+// in. Offsets are 32-bit and the file is an index into the Supervisor's
+// source table, which keeps Position at 12 bytes and Tokens and AST nodes
+// dense. A single source file is therefore limited to 4 GiB and a
+// compilation to 65536 files.
 class [[nodiscard]] Position
 {
   public:
-    [[nodiscard]] static Position create(const std::size_t start, const std::size_t end) noexcept;
+    using SourceId = std::uint16_t;
+
+    static constexpr std::size_t max_offset  = std::numeric_limits<std::uint32_t>::max();
+    static constexpr std::size_t max_sources = std::size_t{std::numeric_limits<SourceId>::max()} + 1;
+
+    [[nodiscard]] static Position
+    create(const SourceId source, const std::size_t start, const std::size_t end) noexcept;
 
     [[nodiscard]] static Position create_dumb() noexcept;
 
@@ -18,13 +30,18 @@ class [[nodiscard]] Position
 
     [[nodiscard]] constexpr std::size_t end() const noexcept { return m_end; }
 
+    [[nodiscard]] constexpr SourceId source() const noexcept { return m_source; }
+
   private:
-    Position(const std::size_t start, const std::size_t end) noexcept;
+    Position(const SourceId source, const std::uint32_t start, const std::uint32_t end) noexcept;
 
-    std::size_t m_start = 0;
-    std::size_t m_end   = 0;
+    std::uint32_t m_start  = 0;
+    std::uint32_t m_end    = 0;
+    SourceId      m_source = 0;
 };
 
+static_assert(sizeof(Position) == 12, "Position is meant to stay a compact 12 bytes.");
+
 // {fmt} formatters
 template <>
 struct fmt::formatter<Position>
@@ -39,6 +56,10 @@ struct fmt::formatter<Position>
     auto format(const Position& position, FormatContext& ctx)
     {
         return fmt::format_to(
-            ctx.out(), "{{ start: {}, end: {} }}", position.start(), position.end());
+            ctx.out(),
+            "{{ source: {}, start: {}, end: {} }}",
+            position.source(),
+            position.start(),
+            position.end());
     }
 };
@@ -0,0 +1,199 @@
+#include "Scanner.hpp"
+
+#include <bit>
+#include <cstdint>
+
+#if defined(__x86_64__)
+#define DL_SCANNER_X86
+#include <immintrin.h>
+#endif
+
+namespace
+{
+
+enum class CharClass : std::uint8_t
+{
+    WHITESPACE,
+    IDENTIFIER,
+    DIGIT,
+    STRING_BODY,
+};
+
+using SpanFunction = std::size_t (*)(std::string_view, std::size_t) noexcept;
+
+template <CharClass Class>
+[[nodiscard]] constexpr bool in_class(const char ch) noexcept
+{
+    if constexpr (Class == CharClass::WHITESPACE) {
+        return ch == ' ' || ch == '\t' || ch == '\r';
+    } else if constexpr (Class == CharClass::IDENTIFIER) {
+        return (ch >= 'a' && ch <= 'z') || (ch >= 'A' && ch <= 'Z') ||
+               (ch >= '0' && ch <= '9') || ch == '_';
+    } else if constexpr (Class == CharClass::DIGIT) {
+        return ch >= '0' && ch <= '9';
+    } else {
+        return ch != '"';
+    }
+}
+
+template <CharClass Class>
+[[nodiscard]] std::size_t span_scalar(const std::string_view source, const std::size_t from) noexcept
+{
+    auto cursor = from;
+    while (cursor < source.size() && in_class<Class>(source[cursor])) { ++cursor; }
+    return cursor - from;
+}
+
+#ifdef DL_SCANNER_X86
+
+// Bytes >= 0x80 compare as negative signed chars, so the range checks below
+// never count them as part of an ASCII run.
+[[nodiscard]] __m128i in_range_sse2(const __m128i chunk, const char lo, const char hi) noexcept
+{
+    return _mm_and_si128(
+        _mm_cmpgt_epi8(chunk, _mm_set1_epi8(static_cast<char>(lo - 1))),
+        _mm_cmplt_epi8(chunk, _mm_set1_epi8(static_cast<char>(hi + 1))));
+}
+
+// One bit per byte of `chunk`, set where the byte ends the run
+template <CharClass Class>
+[[nodiscard]] std::uint32_t stop_bits_sse2(const __m128i chunk) noexcept
+{
+    __m128i run;
+    if constexpr (Class == CharClass::WHITESPACE) {
+        run = _mm_or_si128(
+            _mm_or_si128(
+                _mm_cmpeq_epi8(chunk, _mm_set1_epi8(' ')),
+                _mm_cmpeq_epi8(chunk, _mm_set1_epi8('\t'))),
+            _mm_cmpeq_epi8(chunk, _mm_set1_epi8('\r')));
+    } else if constexpr (Class == CharClass::IDENTIFIER) {
+        // Setting bit 5 folds 'A'-'Z' onto 'a'-'z' and nothing else onto it
+        const auto folded = _mm_or_si128(chunk, _mm_set1_epi8(0x20));
+        run               = _mm_or_si128(
+            _mm_or_si128(in_range_sse2(folded, 'a', 'z'), in_range_sse2(chunk, '0', '9')),
+            _mm_cmpeq_epi8(chunk, _mm_set1_epi8('_')));
+    } else if constexpr (Class == CharClass::DIGIT) {
+        run = in_range_sse2(chunk, '0', '9');
+    } else {
+        return static_cast<std::uint32_t>(
+            _mm_movemask_epi8(_mm_cmpeq_epi8(chunk, _mm_set1_epi8('"'))));
+    }
+
+    return ~static_cast<std::uint32_t>(_mm_movemask_epi8(run)) & 0xFFFFU;
+}
+
+template <CharClass Class>
+[[nodiscard]] std::size_t span_sse2(const std::string_view source, const std::size_t from) noexcept
+{
+    constexpr std::size_t block_size = 16;
+
+    auto cursor = from;
+    while (cursor + block_size <= source.size()) {
+        const auto chunk =
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(source.data() + cursor));
+        if (const auto stop = stop_bits_sse2<Class>(chunk); stop != 0) {
+            return cursor + static_cast<std::size_t>(std::countr_zero(stop)) - from;
+        }
+        cursor += block_size;
+    }
+
+    return cursor - from + span_scalar<Class>(source, cursor);
+}
+
+[[gnu::target("avx2")]] [[nodiscard]] __m256i
+in_range_avx2(const __m256i chunk, const char lo, const char hi) noexcept
+{
+    return _mm256_and_si256(
+        _mm256_cmpgt_epi8(chunk, _mm256_set1_epi8(static_cast<char>(lo - 1))),
+        _mm256_cmpgt_epi8(_mm256_set1_epi8(static_cast<char>(hi + 1)), chunk));
+}
+
+template <CharClass Class>
+[[gnu::target("avx2")]] [[nodiscard]] std::uint32_t stop_bits_avx2(const __m256i chunk) noexcept
+{
+    __m256i run;
+    if constexpr (Class == CharClass::WHITESPACE) {
+        run = _mm256_or_si256(
+            _mm256_or_si256(
+                _mm256_cmpeq_epi8(chunk, _mm256_set1_epi8(' ')),
+                _mm256_cmpeq_epi8(chunk, _mm256_set1_epi8('\t'))),
+            _mm256_cmpeq_epi8(chunk, _mm256_set1_epi8('\r')));
+    } else if constexpr (Class == CharClass::IDENTIFIER) {
+        const auto folded = _mm256_or_si256(chunk, _mm256_set1_epi8(0x20));
+        run               = _mm256_or_si256(
+            _mm256_or_si256(in_range_avx2(folded, 'a', 'z'), in_range_avx2(chunk, '0', '9')),
+            _mm256_cmpeq_epi8(chunk, _mm256_set1_epi8('_')));
+    } else if constexpr (Class == CharClass::DIGIT) {
+        run = in_range_avx2(chunk, '0', '9');
+    } else {
+        return static_cast<std::uint32_t>(
+            _mm256_movemask_epi8(_mm256_cmpeq_epi8(chunk, _mm256_set1_epi8('"'))));
+    }
+
+    return ~static_cast<std::uint32_t>(_mm256_movemask_epi8(run));
+}
+
+template <CharClass Class>
+[[gnu::target("avx2")]] [[nodiscard]] std::size_t
+span_avx2(const std::string_view source, const std::size_t from) noexcept
+{
+    constexpr std::size_t block_size = 32;
+
+    auto cursor = from;
+    while (cursor + block_size <= source.size()) {
+        const auto chunk =
+            _mm256_loadu_si256(reinterpret_cast<const __m256i*>(source.data() + cursor));
+        if (const auto stop = stop_bits_avx2<Class>(chunk); stop != 0) {
+            return cursor + static_cast<std::size_t>(std::countr_zero(stop)) - from;
+        }
+        cursor += block_size;
+    }
+
+    // Finish the tail with the narrower blocks before going scalar
+    return cursor - from + span_sse2<Class>(source, cursor);
+}
+
+#endif // DL_SCANNER_X86
+
+template <CharClass Class>
+[[nodiscard]] SpanFunction select_span() noexcept
+{
+#ifdef DL_SCANNER_X86
+    // SSE2 is part of the x86-64 baseline, only AVX2 needs a runtime check
+    if (__builtin_cpu_supports("avx2")) { return span_avx2<Class>; }
+    return span_sse2<Class>;
+#else
+    return span_scalar<Class>;
+#endif
+}
+
+template <CharClass Class>
+[[nodiscard]] std::size_t span(const std::string_view source, const std::size_t from) noexcept
+{
+    static const SpanFunction implementation = select_span<Class>();
+
+    if (from >= source.size()) { return 0; }
+    return implementation(source, from);
+}
+
+} // namespace
+
+std::size_t Scanner::span_whitespaces(const std::string_view source, const std::size_t from) noexcept
+{
+    return span<CharClass::WHITESPACE>(source, from);
+}
+
+std::size_t Scanner::span_identifier(const std::string_view source, const std::size_t from) noexcept
+{
+    return span<CharClass::IDENTIFIER>(source, from);
+}
+
+std::size_t Scanner::span_digits(const std::string_view source, const std::size_t from) noexcept
+{
+    return span<CharClass::DIGIT>(source, from);
+}
+
+std::size_t Scanner::span_string_body(const std::string_view source, const std::size_t from) noexcept
+{
+    return span<CharClass::STRING_BODY>(source, from);
+}
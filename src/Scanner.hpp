@@ -0,0 +1,29 @@
+#pragma once
+
+#include <cstddef>
+#include <string_view>
+
+// Block-wise scanning of the character runs the lexer spends most of its time
+// in. Every function returns the length of the run that starts at `from`, so
+// the caller can advance past it in one step. On x86 the runs are searched
+// 16 (SSE2) or 32 (AVX2) bytes at a time, the widest instruction set is
+// picked at runtime and anything else falls back to a scalar loop.
+class [[nodiscard]] Scanner
+{
+  public:
+    // ' ', '\t' and '\r', newlines are tokens on their own
+    [[nodiscard]] static std::size_t
+    span_whitespaces(std::string_view source, std::size_t from) noexcept;
+
+    // [A-Za-z0-9_]
+    [[nodiscard]] static std::size_t
+    span_identifier(std::string_view source, std::size_t from) noexcept;
+
+    // [0-9]
+    [[nodiscard]] static std::size_t
+    span_digits(std::string_view source, std::size_t from) noexcept;
+
+    // Everything up to, but excluding, the closing double quote
+    [[nodiscard]] static std::size_t
+    span_string_body(std::string_view source, std::size_t from) noexcept;
+};
@@ -1,97 +1,92 @@
 #include "Statement.hpp"
 
-#include <fmt/format.h>
+#include <iterator>
+#include <string_view>
 #include <utility>
 
+#include <fmt/format.h>
+
+#include "Trace.hpp"
+
 namespace
 {
 
-[[nodiscard]] std::string expand_comma_separated_iterable(auto&& iterable, auto&& callable)
-{
-    return std::accumulate(
-        iterable.begin(), iterable.end(), std::string{}, [&](const auto& acc, const auto& elem) {
-            if (&elem != &iterable.back()) {
-                return acc + callable(elem) + ", ";
-            }
+void append(fmt::memory_buffer& out, const std::string_view code) { out.append(code); }
 
-            return acc + callable(elem);
-        });
+void emit_comma_separated_iterable(fmt::memory_buffer& out, auto&& iterable, auto&& callable)
+{
+    for (const auto& elem : iterable) {
+        callable(elem);
+        if (&elem != &iterable.back()) { append(out, ", "); }
+    }
 }
 
-[[nodiscard]] std::string transpile_type(const Typechecker::Type& type)
+void emit_type(fmt::memory_buffer& out, const Typechecker::Type& type)
 {
     if (std::holds_alternative<Typechecker::BuiltinType>(type.variant())) {
-        return Typechecker::builtin_type_to_c_type(
-            std::get<Typechecker::BuiltinType>(type.variant()));
+        append(
+            out,
+            Typechecker::builtin_type_to_c_type(
+                std::get<Typechecker::BuiltinType>(type.variant())));
+        return;
     }
 
     if (std::holds_alternative<Typechecker::CustomType>(type.variant())) {
         const auto custom_type = std::get<Typechecker::CustomType>(type.variant());
 
         if (custom_type.type == Token::Type::STRUCT) {
-            return custom_type.name;
+            append(out, custom_type.name.name());
+            return;
         }
 
         if (custom_type.type == Token::Type::ENUM) {
-            return fmt::format("__dl_{}", custom_type.name);
+            fmt::format_to(std::back_inserter(out), "__dl_{}", custom_type.name);
+            return;
         }
     }
 
-    return "unreachable";
+    append(out, "unreachable");
 }
 
-[[nodiscard]] std::string compute_mutability(
+void emit_variable_declaration(
+    fmt::memory_buffer&                     out,
     const Typechecker::VariableDeclaration& variable_declaration,
     const bool                              ignore_mutability = false)
 {
-    return !variable_declaration.is_mutable && !ignore_mutability ? "const " : "";
-}
-
-[[nodiscard]] std::string transpile_variable_declaration(
-    const Typechecker::VariableDeclaration& variable_declaration,
-    const bool                              ignore_mutability = false)
-{
-    const std::string mutability =
-        compute_mutability(variable_declaration, ignore_mutability);
-    const std::string variable_type = transpile_type(variable_declaration.type);
+    if (!variable_declaration.is_mutable && !ignore_mutability) { append(out, "const "); }
+    emit_type(out, variable_declaration.type);
 
     if (Typechecker::is_fixed_size_array(variable_declaration.type_extensions)) {
-        return fmt::format(
-            "{}{} {}{}",
-            mutability,
-            variable_type,
+        fmt::format_to(
+            std::back_inserter(out),
+            " {}{}",
             variable_declaration.name,
             variable_declaration.type_extensions);
+        return;
     }
 
-    return fmt::format(
-        "{}{}{} {}",
-        mutability,
-        variable_type,
+    fmt::format_to(
+        std::back_inserter(out),
+        "{} {}",
         variable_declaration.type_extensions,
         variable_declaration.name);
 }
 } // namespace
 
-std::string EmptyStatement::evaluate() const noexcept { return ""; }
+void EmptyStatement::emit([[maybe_unused]] fmt::memory_buffer& out) const noexcept {}
 
-BlockStatement::BlockStatement(std::vector<std::shared_ptr<Statement>> block) noexcept
-    : m_block{std::move(block)}
+BlockStatement::BlockStatement(std::vector<Statement*> block) noexcept
+    : Statement(static_kind),
+      m_block{std::move(block)}
 {
 }
 
-std::string BlockStatement::evaluate() const noexcept
+void BlockStatement::emit(fmt::memory_buffer& out) const noexcept
 {
-    return std::accumulate(
-        m_block.begin(), m_block.end(), std::string{}, [](const auto& acc, const auto& statement) {
-            // check if statement is EmptyStatement
-            if (const auto empty_statement = statement->template as<EmptyStatement>();
-                empty_statement) {
-                return acc + statement->evaluate();
-            }
-
-            return acc + statement->evaluate() + "\n";
-        });
+    for (const auto* statement : m_block) {
+        statement->emit(out);
+        if (statement->as<EmptyStatement>() == nullptr) { out.push_back('\n'); }
+    }
 }
 
 auto BlockStatement::empty() const noexcept { return m_block.empty(); }
@@ -102,7 +97,8 @@ ModuleStatement::ModuleStatement(
     BlockStatement           structs,
     BlockStatement           enums,
     BlockStatement           functions) noexcept
-    : m_name{std::move(name)},
+    : Statement(static_kind),
+      m_name{std::move(name)},
       m_c_includes{std::move(c_includes)},
       m_structs{std::move(structs)},
       m_enums{std::move(enums)},
@@ -110,19 +106,39 @@ ModuleStatement::ModuleStatement(
 {
 }
 
-std::string ModuleStatement::evaluate() const noexcept
+void ModuleStatement::emit(fmt::memory_buffer& out) const noexcept
 {
-    const auto c_includes = std::accumulate(
-        m_c_includes.begin(), m_c_includes.end(), std::string{}, [](const auto& acc, const auto& c_include) {
-            return acc +
-                   fmt::format("#include <{}>\n", c_include.substr(1, c_include.size() - 2));
-        });
+    emit_types(out);
+    m_functions.emit(out);
+}
 
-    const auto enums_code     = m_enums.evaluate();
-    const auto structs_code   = m_structs.evaluate();
-    const auto functions_code = m_functions.evaluate();
+void ModuleStatement::emit_declarations(fmt::memory_buffer& out) const noexcept
+{
+    emit_types(out);
+    for (const auto* function : m_functions.data()) {
+        function->as<FunctionStatement>()->emit_prototype(out);
+    }
+}
+
+void ModuleStatement::emit_definitions(fmt::memory_buffer& out) const noexcept
+{
+    m_functions.emit(out);
+}
+
+void ModuleStatement::emit_types(fmt::memory_buffer& out) const noexcept
+{
+    for (const auto& c_include : m_c_includes) {
+        fmt::format_to(
+            std::back_inserter(out),
+            "#include <{}>\n",
+            std::string_view(c_include).substr(1, c_include.size() - 2));
+    }
 
-    return fmt::format("{}\n{}\n{}\n{}", c_includes, enums_code, structs_code, functions_code);
+    out.push_back('\n');
+    m_enums.emit(out);
+    out.push_back('\n');
+    m_structs.emit(out);
+    out.push_back('\n');
 }
 
 FunctionStatement::FunctionStatement(
@@ -130,243 +146,265 @@ FunctionStatement::FunctionStatement(
     std::vector<Typechecker::VariableDeclaration> args,
     std::string                                   return_type,
     BlockStatement                                body) noexcept
-    : m_name{std::move(name)},
+    : Statement(static_kind),
+      m_name{std::move(name)},
       m_args{std::move(args)},
       m_return_type{std::move(return_type)},
       m_body{std::move(body)}
 {
 }
 
-std::string FunctionStatement::evaluate() const noexcept
+void FunctionStatement::emit(fmt::memory_buffer& out) const noexcept
 {
-    // FIXME: Return value should be a proper type instead of a std::string
-    const std::string return_value =
-        Typechecker::builtin_type_from_string(m_return_type) != Typechecker::BuiltinType::NONE
-            ? Typechecker::builtin_type_to_c_type(m_return_type)
-            : m_return_type;
+    TraceSpan span("emit", m_name);
 
-    const auto args = expand_comma_separated_iterable(m_args, [](const auto& arg) {
-        return transpile_variable_declaration(arg);
-    });
+    emit_signature(out);
+    append(out, " {\n");
+    m_body.emit(out);
+    append(out, "}\n");
+}
+
+void FunctionStatement::emit_prototype(fmt::memory_buffer& out) const noexcept
+{
+    emit_signature(out);
+    append(out, ";\n");
+}
+
+void FunctionStatement::emit_signature(fmt::memory_buffer& out) const noexcept
+{
+    // FIXME: Return value should be a proper type instead of a std::string
+    if (Typechecker::builtin_type_from_string(m_return_type) != Typechecker::BuiltinType::NONE) {
+        append(out, Typechecker::builtin_type_to_c_type(m_return_type));
+    } else {
+        append(out, m_return_type);
+    }
 
-    return fmt::format(
-        "{} {}({}) {{\n{}}}\n", return_value, m_name, args, m_body.evaluate());
+    fmt::format_to(std::back_inserter(out), " {}(", m_name);
+    emit_comma_separated_iterable(
+        out, m_args, [&out](const auto& arg) { emit_variable_declaration(out, arg); });
+    out.push_back(')');
 }
 
-IfStatement::IfStatement(std::shared_ptr<Expression> condition, BlockStatement then_block, BlockStatement else_block) noexcept
-    : m_condition{std::move(condition)},
+IfStatement::IfStatement(Expression* condition, BlockStatement then_block, BlockStatement else_block) noexcept
+    : Statement(static_kind),
+      m_condition{condition},
       m_then_block{std::move(then_block)},
       m_else_block{std::move(else_block)}
 {
 }
 
-std::string IfStatement::evaluate() const noexcept
+void IfStatement::emit(fmt::memory_buffer& out) const noexcept
 {
-    const auto then_block = fmt::format(
-        "if ({}) {{\n{}\n}}", m_condition->evaluate(), m_then_block.evaluate());
-
-    const auto else_block = !m_else_block.empty()
-                              ? fmt::format(" else {{\n{}\n}}", m_else_block.evaluate())
-                              : "";
-
-    return fmt::format("{}{}", then_block, else_block);
+    append(out, "if (");
+    m_condition->emit(out);
+    append(out, ") {\n");
+    m_then_block.emit(out);
+    append(out, "\n}");
+
+    if (!m_else_block.empty()) {
+        append(out, " else {\n");
+        m_else_block.emit(out);
+        append(out, "\n}");
+    }
 }
 
-ReturnStatement::ReturnStatement(std::shared_ptr<Expression> expression) noexcept
-    : m_expression{std::move(expression)}
+ReturnStatement::ReturnStatement(Expression* expression) noexcept
+    : Statement(static_kind),
+      m_expression{expression}
 {
 }
 
-std::string ReturnStatement::evaluate() const noexcept
+void ReturnStatement::emit(fmt::memory_buffer& out) const noexcept
 {
-    return fmt::format("return {};", m_expression->evaluate());
+    append(out, "return ");
+    m_expression->emit(out);
+    out.push_back(';');
 }
 
 VariableStatement::VariableStatement(
     Typechecker::VariableDeclaration variable,
-    std::shared_ptr<Expression>      expression) noexcept
-    : m_variable_declaration{std::move(variable)},
-      m_expression{std::move(expression)}
+    Expression*                      expression) noexcept
+    : Statement(static_kind),
+      m_variable_declaration{std::move(variable)},
+      m_expression{expression}
 {
 }
 
-std::string VariableStatement::evaluate() const noexcept
+void VariableStatement::emit(fmt::memory_buffer& out) const noexcept
 {
-    return fmt::format(
-        "{} = {};",
-        transpile_variable_declaration(m_variable_declaration),
-        m_expression->evaluate());
+    emit_variable_declaration(out, m_variable_declaration);
+    append(out, " = ");
+    m_expression->emit(out);
+    out.push_back(';');
 }
 
-WhileStatement::WhileStatement(std::shared_ptr<Expression> condition, BlockStatement body) noexcept
-    : m_condition{std::move(condition)},
+WhileStatement::WhileStatement(Expression* condition, BlockStatement body) noexcept
+    : Statement(static_kind),
+      m_condition{condition},
       m_body{std::move(body)}
 {
 }
 
-std::string WhileStatement::evaluate() const noexcept
+void WhileStatement::emit(fmt::memory_buffer& out) const noexcept
 {
-    return fmt::format("while ({}) {{\n{}\n}}", m_condition->evaluate(), m_body.evaluate());
+    append(out, "while (");
+    m_condition->emit(out);
+    append(out, ") {\n");
+    m_body.emit(out);
+    append(out, "\n}");
 }
 
 ForStatement::ForStatement(
-    std::shared_ptr<Statement>  init_statement,
-    std::shared_ptr<Expression> condition,
-    std::shared_ptr<Expression> increment_statement,
-    BlockStatement              body) noexcept
-    : m_init_statement{std::move(init_statement)},
-      m_condition{std::move(condition)},
-      m_increment_statement{std::move(increment_statement)},
+    Statement*     init_statement,
+    Expression*    condition,
+    Expression*    increment_statement,
+    BlockStatement body) noexcept
+    : Statement(static_kind),
+      m_init_statement{init_statement},
+      m_condition{condition},
+      m_increment_statement{increment_statement},
       m_body{std::move(body)}
 {
 }
 
-std::string ForStatement::evaluate() const noexcept
+void ForStatement::emit(fmt::memory_buffer& out) const noexcept
 {
-    return fmt::format(
-        "for ({} {}; {}) {{\n{}}}\n",
-        m_init_statement->evaluate(),
-        m_condition->evaluate(),
-        m_increment_statement->evaluate(),
-        m_body.evaluate());
+    append(out, "for (");
+    m_init_statement->emit(out);
+    out.push_back(' ');
+    m_condition->emit(out);
+    append(out, "; ");
+    m_increment_statement->emit(out);
+    append(out, ") {\n");
+    m_body.emit(out);
+    append(out, "}\n");
 }
 
-ExpressionStatement::ExpressionStatement(std::shared_ptr<Expression> expression) noexcept
-    : m_expression{std::move(expression)}
+ExpressionStatement::ExpressionStatement(Expression* expression) noexcept
+    : Statement(static_kind),
+      m_expression{expression}
 {
 }
 
-std::string ExpressionStatement::evaluate() const noexcept
+void ExpressionStatement::emit(fmt::memory_buffer& out) const noexcept
 {
-    return fmt::format("{};", m_expression->evaluate());
+    m_expression->emit(out);
+    out.push_back(';');
 }
 
 
 ArrayStatement::ArrayStatement(
-    Typechecker::VariableDeclaration         variable_declaration,
-    std::vector<std::shared_ptr<Expression>> elements) noexcept
-    : m_variable_declaration{std::move(variable_declaration)},
+    Typechecker::VariableDeclaration variable_declaration,
+    std::vector<Expression*>         elements) noexcept
+    : Statement(static_kind),
+      m_variable_declaration{std::move(variable_declaration)},
       m_elements{std::move(elements)}
 {
 }
 
-std::string ArrayStatement::evaluate() const noexcept
+void ArrayStatement::emit(fmt::memory_buffer& out) const noexcept
 {
-    const auto array_elements = expand_comma_separated_iterable(
-        m_elements, [](const auto& element) { return element->evaluate(); });
-
-    return fmt::format(
-        "{} = {{{}}};\n", transpile_variable_declaration(m_variable_declaration), array_elements);
+    emit_variable_declaration(out, m_variable_declaration);
+    append(out, " = {");
+    emit_comma_separated_iterable(
+        out, m_elements, [&out](const auto* element) { element->emit(out); });
+    append(out, "};\n");
 }
 
 StructStatement::StructStatement(std::string name, std::vector<Typechecker::VariableDeclaration> member_variables) noexcept
-    : m_name{std::move(name)},
+    : Statement(static_kind),
+      m_name{std::move(name)},
       m_member_variables{std::move(member_variables)}
 {
 }
 
-std::string StructStatement::evaluate() const noexcept
+void StructStatement::emit(fmt::memory_buffer& out) const noexcept
 {
-    const auto member_variables = std::accumulate(
-        m_member_variables.begin(),
-        m_member_variables.end(),
-        std::string{},
-        [](const auto& acc, const auto& member_variable) {
-            return acc + fmt::format("{};\n", transpile_variable_declaration(member_variable, true));
-        });
-
-    const auto default_constructor_params =
-        expand_comma_separated_iterable(m_member_variables, [](const auto& member_variable) {
-            return transpile_variable_declaration(member_variable, true);
-        });
-
-    const auto default_constructor_arguments =
-        expand_comma_separated_iterable(m_member_variables, [](const auto& member_variable) {
-            return fmt::format(".{} = {}", member_variable.name, member_variable.name);
-        });
-
-    const auto default_constructor_body =
-        fmt::format("return {{ {} }};", default_constructor_arguments);
-
-    const auto default_constructor = fmt::format(
-        "static {} create({}) {{\n{}\n}}", m_name, default_constructor_params, default_constructor_body);
+    fmt::format_to(std::back_inserter(out), "struct {} {{\n", m_name);
+    for (const auto& member_variable : m_member_variables) {
+        emit_variable_declaration(out, member_variable, true);
+        append(out, ";\n");
+    }
 
-    return fmt::format("struct {} {{\n{}\n{}\n}};", m_name, member_variables, default_constructor);
+    // Default constructor
+    fmt::format_to(std::back_inserter(out), "\nstatic {} create(", m_name);
+    emit_comma_separated_iterable(out, m_member_variables, [&out](const auto& member_variable) {
+        emit_variable_declaration(out, member_variable, true);
+    });
+    append(out, ") {\nreturn { ");
+    emit_comma_separated_iterable(out, m_member_variables, [&out](const auto& member_variable) {
+        fmt::format_to(
+            std::back_inserter(out), ".{} = {}", member_variable.name, member_variable.name);
+    });
+    append(out, " };\n}\n};");
 }
 
 EnumStatement::EnumStatement(std::string name, EnumStatement::EnumVariant variants) noexcept
-    : m_name{std::move(name)},
+    : Statement(static_kind),
+      m_name{std::move(name)},
       m_enum_variants{std::move(variants)}
 {
 }
 
-std::string EnumStatement::evaluate() const noexcept
+void EnumStatement::emit(fmt::memory_buffer& out) const noexcept
 {
     const auto* const underlying_type = "unsigned long long int";
 
-    const auto enum_variants = std::accumulate(
-        m_enum_variants.begin(),
-        m_enum_variants.end(),
-        std::string{},
-        [](const auto& acc, const auto& enum_variant) {
-            return acc + fmt::format("{},\n", enum_variant.first);
-        });
-
-    const auto enum_code =
-        fmt::format("enum class {} : {} {{\n{}\n}};", m_name, underlying_type, enum_variants);
-
-    std::stringstream associated_union_fields{};
+    fmt::format_to(
+        std::back_inserter(out), "enum class {} : {} {{\n", m_name, underlying_type);
     for (const auto& [name, fields] : m_enum_variants) {
-        const auto struct_fields = std::accumulate(
-            fields.begin(), fields.end(), std::string{}, [i = 0](const auto& acc, const auto& field) mutable {
-                return acc + fmt::format("{} data_{};\n", transpile_type(field), i++);
-            });
-        associated_union_fields
-            << fmt::format("struct {{ {} }} {}_data;\n", struct_fields, name);
+        fmt::format_to(std::back_inserter(out), "{},\n", name);
     }
+    append(out, "\n};\n");
 
-    const auto associated_union_code =
-        fmt::format("union {{\n{}\n}};", associated_union_fields.str());
-
-    std::stringstream associated_structs_default_constructors = {};
+    // Associated struct, tagged by the enum above
+    fmt::format_to(std::back_inserter(out), "struct __dl_{} {{\n{} type;\nunion {{\n", m_name, m_name);
     for (const auto& [name, fields] : m_enum_variants) {
-        const auto params = expand_comma_separated_iterable(
-            fields, [&name, it = 0](const auto& field) mutable {
-                return fmt::format("{} {}_{}", transpile_type(field), name, it++);
-            });
-
-        const auto arguments = expand_comma_separated_iterable(
-            fields, [&name, it = 0]([[maybe_unused]] const auto& field) mutable {
-                auto retval = fmt::format(".data_{} = {}_{}", it, name, it);
-                it++;
-                return retval;
-            });
-
-        const auto associated_struct_default_constructor_body = fmt::format(
-            "return __dl_{} {{ .type = {}::{}, .{}_data = {{ {} }} }};", m_name, m_name, name, name, arguments);
-        associated_structs_default_constructors << fmt::format(
-            "static __dl_{} {}({}){{\n{}\n}}", m_name, name, params, associated_struct_default_constructor_body);
+        append(out, "struct { ");
+        for (std::size_t i = 0; i < fields.size(); ++i) {
+            emit_type(out, fields[i]);
+            fmt::format_to(std::back_inserter(out), " data_{};\n", i);
+        }
+        fmt::format_to(std::back_inserter(out), " }} {}_data;\n", name);
     }
+    append(out, "\n};\n");
 
-    const auto associated_struct_code = fmt::format(
-        "struct __dl_{} {{\n{} type;\n{}\n{}\n}};",
-        m_name,
-        m_name,
-        associated_union_code,
-        associated_structs_default_constructors.str());
+    for (const auto& [name, fields] : m_enum_variants) {
+        fmt::format_to(std::back_inserter(out), "static __dl_{} {}(", m_name, name);
+        for (std::size_t i = 0; i < fields.size(); ++i) {
+            emit_type(out, fields[i]);
+            fmt::format_to(std::back_inserter(out), " {}_{}", name, i);
+            if (i + 1 != fields.size()) { append(out, ", "); }
+        }
 
-    return fmt::format("{}\n{}\n", enum_code, associated_struct_code);
+        fmt::format_to(
+            std::back_inserter(out),
+            "){{\nreturn __dl_{} {{ .type = {}::{}, .{}_data = {{ ",
+            m_name,
+            m_name,
+            name,
+            name);
+        for (std::size_t i = 0; i < fields.size(); ++i) {
+            fmt::format_to(std::back_inserter(out), ".data_{} = {}_{}", i, name, i);
+            if (i + 1 != fields.size()) { append(out, ", "); }
+        }
+        append(out, " } };\n}");
+    }
+    append(out, "\n};\n");
 }
 
-MatchStatement::MatchStatement(const std::shared_ptr<Expression>& expression, std::vector<MatchCase> cases) noexcept
-    : m_expression{expression},
+MatchStatement::MatchStatement(Expression* expression, std::vector<MatchCase> cases) noexcept
+    : Statement(static_kind),
+      m_expression{expression},
       m_cases{std::move(cases)}
 {
 }
 
-std::string MatchStatement::evaluate() const noexcept
+void MatchStatement::emit(fmt::memory_buffer& out) const noexcept
 {
-    std::stringstream match_cases = {};
+    const auto expression = m_expression->evaluate();
+
+    fmt::format_to(std::back_inserter(out), "switch ({}.type) {{\n", expression);
     for (const auto& [label, destructuring, body] : m_cases) {
         std::string enum_variant;
 
@@ -382,27 +420,31 @@ std::string MatchStatement::evaluate() const noexcept
             fmt::format("{}::{}", label->enum_base()->evaluate(), enum_variant);
 
         if (evaluated_label != "_") {
-            match_cases << fmt::format("case {}: {{\n", evaluated_label);
+            fmt::format_to(std::back_inserter(out), "case {}: {{\n", evaluated_label);
         } else {
-            match_cases << fmt::format("default: {{\n");
+            append(out, "default: {\n");
         }
 
-        const auto destructures = std::accumulate(
-            destructuring.begin(),
-            destructuring.end(),
-            std::string{},
-            [this, &enum_variant, i = 0](const auto& acc, const auto& destructure) mutable {
-                return acc + fmt::format(
-                                 "const auto {} = {}.{}_data.data_{};\n",
-                                 destructure,
-                                 m_expression->evaluate(),
-                                 enum_variant,
-                                 i++);
-            });
-
-        match_cases << fmt::format("{}\n{}break;\n}}\n", destructures, body.evaluate());
+        for (std::size_t i = 0; i < destructuring.size(); ++i) {
+            fmt::format_to(
+                std::back_inserter(out),
+                "const auto {} = {}.{}_data.data_{};\n",
+                destructuring[i],
+                expression,
+                enum_variant,
+                i);
+        }
+
+        out.push_back('\n');
+        body.emit(out);
+        append(out, "break;\n}\n");
     }
+    append(out, "\n}");
+}
 
-    return fmt::format(
-        "switch ({}.type) {{\n{}\n}}", m_expression->evaluate(), match_cases.str());
+std::string Statement::evaluate() const noexcept
+{
+    fmt::memory_buffer out;
+    emit(out);
+    return fmt::to_string(out);
 }
@@ -1,7 +1,7 @@
 #pragma once
 
 #include <algorithm>
-#include <memory>
+#include <cstdint>
 #include <numeric>
 #include <ranges>
 #include <string>
@@ -17,7 +17,25 @@
 class [[nodiscard]] Statement
 {
   public:
-    Statement() = default;
+    enum class Kind : std::uint8_t
+    {
+        EMPTY,
+        BLOCK,
+        MODULE,
+        FUNCTION,
+        IF,
+        RETURN,
+        VARIABLE,
+        WHILE,
+        FOR,
+        EXPRESSION,
+        ARRAY,
+        STRUCT,
+        ENUM,
+        MATCH,
+    };
+
+    explicit Statement(const Kind kind) noexcept : m_kind{kind} {}
 
     virtual ~Statement() = default;
 
@@ -29,44 +47,82 @@ class [[nodiscard]] Statement
 
     Statement& operator=(Statement&&) = default;
 
-    [[nodiscard]] virtual std::string evaluate() const noexcept = 0;
+    // Appends the generated C++ for this node to `out`, the whole program is
+    // generated into one buffer instead of concatenating per-node strings
+    virtual void emit(fmt::memory_buffer& out) const noexcept = 0;
+
+    // The generated C++ for this node alone, for callers that need it as a
+    // standalone value rather than as part of the program
+    [[nodiscard]] std::string evaluate() const noexcept;
 
+    [[nodiscard]] constexpr Kind kind() const noexcept { return m_kind; }
+
+    // Checked downcast driven by the node kind, RTTI is not required
     template <typename To>
     [[nodiscard]] To* as() noexcept
     {
-        return dynamic_cast<To*>(this);
+        return m_kind == To::static_kind ? static_cast<To*>(this) : nullptr;
     }
+
+    template <typename To>
+    [[nodiscard]] const To* as() const noexcept
+    {
+        return m_kind == To::static_kind ? static_cast<const To*>(this) : nullptr;
+    }
+
+    // Calls `visitor` with the node downcast to its concrete type
+    template <typename Visitor>
+    decltype(auto) visit(Visitor&& visitor);
+
+    template <typename Visitor>
+    decltype(auto) visit(Visitor&& visitor) const;
+
+  private:
+    Kind m_kind;
 };
 
 class [[nodiscard]] EmptyStatement final : public Statement
 {
   public:
-    EmptyStatement() noexcept = default;
+    static constexpr Kind static_kind = Kind::EMPTY;
 
-    [[nodiscard]] std::string evaluate() const noexcept override;
+    EmptyStatement() noexcept : Statement(static_kind) {}
+
+    void emit(fmt::memory_buffer& out) const noexcept override;
 };
 
 class [[nodiscard]] BlockStatement final : public Statement
 {
   public:
-    explicit BlockStatement(std::vector<std::shared_ptr<Statement>> block) noexcept;
+    static constexpr Kind static_kind = Kind::BLOCK;
+
+    explicit BlockStatement(std::vector<Statement*> block) noexcept;
 
     [[nodiscard]] auto empty() const noexcept;
 
-    [[nodiscard]] const std::vector<std::shared_ptr<Statement>>& data() const noexcept
+    [[nodiscard]] const std::vector<Statement*>& data() const noexcept
     {
         return m_block;
     }
 
-    [[nodiscard]] std::string evaluate() const noexcept override;
+    // Drops the statements `keep` rejects, returns how many were dropped
+    template <typename Predicate>
+    std::size_t retain(Predicate&& keep) noexcept
+    {
+        return std::erase_if(m_block, [&keep](const Statement* statement) { return !keep(*statement); });
+    }
+
+    void emit(fmt::memory_buffer& out) const noexcept override;
 
   private:
-    std::vector<std::shared_ptr<Statement>> m_block;
+    std::vector<Statement*> m_block;
 };
 
 class [[nodiscard]] ModuleStatement final : public Statement
 {
   public:
+    static constexpr Kind static_kind = Kind::MODULE;
+
     explicit ModuleStatement(
         std::string              name,
         std::vector<std::string> c_includes,
@@ -74,9 +130,39 @@ class [[nodiscard]] ModuleStatement final : public Statement
         BlockStatement           enums,
         BlockStatement           functions) noexcept;
 
-    [[nodiscard]] std::string evaluate() const noexcept override;
+    [[nodiscard]] const std::string& name() const noexcept { return m_name; }
+
+    [[nodiscard]] const std::vector<std::string>& c_includes() const noexcept
+    {
+        return m_c_includes;
+    }
+
+    [[nodiscard]] const BlockStatement& structs() const noexcept { return m_structs; }
+
+    [[nodiscard]] const BlockStatement& enums() const noexcept { return m_enums; }
+
+    [[nodiscard]] const BlockStatement& functions() const noexcept { return m_functions; }
+
+    // Drops the structs, enums and functions `keep` rejects so they are not
+    // emitted, returns how many were dropped
+    template <typename Predicate>
+    std::size_t retain(Predicate&& keep) noexcept
+    {
+        return m_structs.retain(keep) + m_enums.retain(keep) + m_functions.retain(keep);
+    }
+
+    void emit(fmt::memory_buffer& out) const noexcept override;
+
+    // What other translation units need to use this module: its C includes,
+    // enums, structs and function prototypes
+    void emit_declarations(fmt::memory_buffer& out) const noexcept;
+
+    // The function definitions, to be compiled after emit_declarations()
+    void emit_definitions(fmt::memory_buffer& out) const noexcept;
 
   private:
+    void emit_types(fmt::memory_buffer& out) const noexcept;
+
     std::string              m_name;
     std::vector<std::string> m_c_includes;
     BlockStatement           m_structs;
@@ -87,15 +173,33 @@ class [[nodiscard]] ModuleStatement final : public Statement
 class [[nodiscard]] FunctionStatement final : public Statement
 {
   public:
+    static constexpr Kind static_kind = Kind::FUNCTION;
+
     FunctionStatement(
         std::string                                   name,
         std::vector<Typechecker::VariableDeclaration> args,
         std::string                                   return_type,
         BlockStatement                                body) noexcept;
 
-    [[nodiscard]] std::string evaluate() const noexcept override;
+    [[nodiscard]] const std::string& name() const noexcept { return m_name; }
+
+    [[nodiscard]] const std::vector<Typechecker::VariableDeclaration>& args() const noexcept
+    {
+        return m_args;
+    }
+
+    // As written after '->', empty for functions returning nothing
+    [[nodiscard]] const std::string& return_type() const noexcept { return m_return_type; }
+
+    [[nodiscard]] const BlockStatement& body() const noexcept { return m_body; }
+
+    void emit(fmt::memory_buffer& out) const noexcept override;
+
+    void emit_prototype(fmt::memory_buffer& out) const noexcept;
 
   private:
+    void emit_signature(fmt::memory_buffer& out) const noexcept;
+
     std::string                                   m_name;
     std::vector<Typechecker::VariableDeclaration> m_args;
     std::string                                   m_return_type;
@@ -105,102 +209,184 @@ class [[nodiscard]] FunctionStatement final : public Statement
 class [[nodiscard]] IfStatement final : public Statement
 {
   public:
-    IfStatement(std::shared_ptr<Expression> condition, BlockStatement then_block, BlockStatement else_block) noexcept;
+    static constexpr Kind static_kind = Kind::IF;
+
+    IfStatement(Expression* condition, BlockStatement then_block, BlockStatement else_block) noexcept;
+
+    [[nodiscard]] Expression* condition() const noexcept { return m_condition; }
 
-    [[nodiscard]] std::string evaluate() const noexcept override;
+    [[nodiscard]] const BlockStatement& then_block() const noexcept { return m_then_block; }
+
+    [[nodiscard]] const BlockStatement& else_block() const noexcept { return m_else_block; }
+
+    void set_condition(Expression* condition) noexcept { m_condition = condition; }
+
+    void emit(fmt::memory_buffer& out) const noexcept override;
 
   private:
-    std::shared_ptr<Expression> m_condition;
-    BlockStatement              m_then_block;
-    BlockStatement              m_else_block;
+    Expression*    m_condition;
+    BlockStatement m_then_block;
+    BlockStatement m_else_block;
 };
 
 class [[nodiscard]] ReturnStatement final : public Statement
 {
   public:
-    explicit ReturnStatement(std::shared_ptr<Expression> expression) noexcept;
+    static constexpr Kind static_kind = Kind::RETURN;
+
+    explicit ReturnStatement(Expression* expression) noexcept;
+
+    [[nodiscard]] Expression* expression() const noexcept { return m_expression; }
+
+    void set_expression(Expression* expression) noexcept { m_expression = expression; }
 
-    [[nodiscard]] std::string evaluate() const noexcept override;
+    void emit(fmt::memory_buffer& out) const noexcept override;
 
   private:
-    std::shared_ptr<Expression> m_expression;
+    Expression* m_expression;
 };
 
 class [[nodiscard]] VariableStatement final : public Statement
 {
   public:
-    VariableStatement(Typechecker::VariableDeclaration variable, std::shared_ptr<Expression> expression) noexcept;
+    static constexpr Kind static_kind = Kind::VARIABLE;
 
-    [[nodiscard]] std::string evaluate() const noexcept override;
+    VariableStatement(Typechecker::VariableDeclaration variable, Expression* expression) noexcept;
+
+    [[nodiscard]] const Typechecker::VariableDeclaration& variable_declaration() const noexcept
+    {
+        return m_variable_declaration;
+    }
+
+    [[nodiscard]] Expression* expression() const noexcept { return m_expression; }
+
+    void set_expression(Expression* expression) noexcept { m_expression = expression; }
+
+    void emit(fmt::memory_buffer& out) const noexcept override;
 
   private:
     Typechecker::VariableDeclaration m_variable_declaration;
-    std::shared_ptr<Expression>      m_expression;
+    Expression*                      m_expression;
 };
 
 class [[nodiscard]] WhileStatement final : public Statement
 {
   public:
-    WhileStatement(std::shared_ptr<Expression> condition, BlockStatement body) noexcept;
+    static constexpr Kind static_kind = Kind::WHILE;
+
+    WhileStatement(Expression* condition, BlockStatement body) noexcept;
 
-    [[nodiscard]] std::string evaluate() const noexcept override;
+    [[nodiscard]] Expression* condition() const noexcept { return m_condition; }
+
+    [[nodiscard]] const BlockStatement& body() const noexcept { return m_body; }
+
+    void set_condition(Expression* condition) noexcept { m_condition = condition; }
+
+    void emit(fmt::memory_buffer& out) const noexcept override;
 
   private:
-    std::shared_ptr<Expression> m_condition;
-    BlockStatement              m_body;
+    Expression*    m_condition;
+    BlockStatement m_body;
 };
 
 class [[nodiscard]] ForStatement final : public Statement
 {
   public:
+    static constexpr Kind static_kind = Kind::FOR;
+
     ForStatement(
-        std::shared_ptr<Statement>  init_statement,
-        std::shared_ptr<Expression> condition,
-        std::shared_ptr<Expression> increment_statement,
-        BlockStatement              body) noexcept;
+        Statement*     init_statement,
+        Expression*    condition,
+        Expression*    increment_statement,
+        BlockStatement body) noexcept;
+
+    [[nodiscard]] Statement* init_statement() const noexcept { return m_init_statement; }
 
-    [[nodiscard]] std::string evaluate() const noexcept override;
+    [[nodiscard]] Expression* condition() const noexcept { return m_condition; }
+
+    [[nodiscard]] Expression* increment_statement() const noexcept
+    {
+        return m_increment_statement;
+    }
+
+    [[nodiscard]] const BlockStatement& body() const noexcept { return m_body; }
+
+    void set_condition(Expression* condition) noexcept { m_condition = condition; }
+
+    void set_increment_statement(Expression* increment_statement) noexcept
+    {
+        m_increment_statement = increment_statement;
+    }
+
+    void emit(fmt::memory_buffer& out) const noexcept override;
 
   private:
-    std::shared_ptr<Statement>  m_init_statement;
-    std::shared_ptr<Expression> m_condition;
-    std::shared_ptr<Expression> m_increment_statement;
-    BlockStatement              m_body;
+    Statement*     m_init_statement;
+    Expression*    m_condition;
+    Expression*    m_increment_statement;
+    BlockStatement m_body;
 };
 
 class [[nodiscard]] ExpressionStatement final : public Statement
 {
   public:
-    explicit ExpressionStatement(std::shared_ptr<Expression> expression) noexcept;
+    static constexpr Kind static_kind = Kind::EXPRESSION;
+
+    explicit ExpressionStatement(Expression* expression) noexcept;
 
-    [[nodiscard]] std::string evaluate() const noexcept override;
+    [[nodiscard]] Expression* expression() const noexcept { return m_expression; }
+
+    void set_expression(Expression* expression) noexcept { m_expression = expression; }
+
+    void emit(fmt::memory_buffer& out) const noexcept override;
 
   private:
-    std::shared_ptr<Expression> m_expression;
+    Expression* m_expression;
 };
 
 class [[nodiscard]] ArrayStatement final : public Statement
 {
   public:
+    static constexpr Kind static_kind = Kind::ARRAY;
+
     ArrayStatement(
-        Typechecker::VariableDeclaration         variable_declaration,
-        std::vector<std::shared_ptr<Expression>> elements) noexcept;
+        Typechecker::VariableDeclaration variable_declaration,
+        std::vector<Expression*>         elements) noexcept;
 
-    [[nodiscard]] std::string evaluate() const noexcept override;
+    [[nodiscard]] const Typechecker::VariableDeclaration& variable_declaration() const noexcept
+    {
+        return m_variable_declaration;
+    }
+
+    [[nodiscard]] const std::vector<Expression*>& elements() const noexcept { return m_elements; }
+
+    void set_element(const std::size_t index, Expression* element) noexcept
+    {
+        m_elements[index] = element;
+    }
+
+    void emit(fmt::memory_buffer& out) const noexcept override;
 
   private:
-    Typechecker::VariableDeclaration         m_variable_declaration;
-    std::vector<std::shared_ptr<Expression>> m_elements;
+    Typechecker::VariableDeclaration m_variable_declaration;
+    std::vector<Expression*>         m_elements;
 };
 
 class [[nodiscard]] StructStatement final : public Statement
 {
   public:
+    static constexpr Kind static_kind = Kind::STRUCT;
+
     StructStatement(std::string name, std::vector<Typechecker::VariableDeclaration> member_variables) noexcept;
 
     [[nodiscard]] const std::string& name() const noexcept { return m_name; }
 
-    [[nodiscard]] std::string evaluate() const noexcept override;
+    [[nodiscard]] const std::vector<Typechecker::VariableDeclaration>& member_variables() const noexcept
+    {
+        return m_member_variables;
+    }
+
+    void emit(fmt::memory_buffer& out) const noexcept override;
 
   private:
     std::string                                   m_name;
@@ -210,7 +396,9 @@ class [[nodiscard]] StructStatement final : public Statement
 class [[nodiscard]] EnumStatement final : public Statement
 {
   public:
-    using EnumVariant = std::unordered_map<std::string, std::vector<Typechecker::Type>>;
+    static constexpr Kind static_kind = Kind::ENUM;
+
+    using EnumVariant = std::unordered_map<Symbol, std::vector<Typechecker::Type>>;
 
     EnumStatement(std::string name, EnumVariant variants) noexcept;
 
@@ -221,7 +409,7 @@ class [[nodiscard]] EnumStatement final : public Statement
         return m_enum_variants;
     }
 
-    [[nodiscard]] std::string evaluate() const noexcept override;
+    void emit(fmt::memory_buffer& out) const noexcept override;
 
   private:
     std::string m_name;
@@ -231,18 +419,128 @@ class [[nodiscard]] EnumStatement final : public Statement
 class [[nodiscard]] MatchStatement final : public Statement
 {
   public:
+    static constexpr Kind static_kind = Kind::MATCH;
+
     struct [[nodiscard]] MatchCase
     {
-        std::shared_ptr<EnumExpression> label;
-        std::vector<std::string>        destructuring;
-        BlockStatement                  body;
+        EnumExpression*          label;
+        std::vector<std::string> destructuring;
+        BlockStatement           body;
     };
 
-    MatchStatement(const std::shared_ptr<Expression>& expression, std::vector<MatchCase> cases) noexcept;
+    MatchStatement(Expression* expression, std::vector<MatchCase> cases) noexcept;
+
+    [[nodiscard]] Expression* expression() const noexcept { return m_expression; }
+
+    void set_expression(Expression* expression) noexcept { m_expression = expression; }
 
-    [[nodiscard]] std::string evaluate() const noexcept override;
+    [[nodiscard]] const std::vector<MatchCase>& cases() const noexcept { return m_cases; }
+
+    void emit(fmt::memory_buffer& out) const noexcept override;
 
   private:
-    std::shared_ptr<Expression> m_expression;
-    std::vector<MatchCase>      m_cases;
+    Expression*            m_expression;
+    std::vector<MatchCase> m_cases;
 };
+
+template <typename Visitor>
+decltype(auto) Statement::visit(Visitor&& visitor)
+{
+    switch (m_kind) {
+        case Kind::EMPTY: {
+            return visitor(static_cast<EmptyStatement&>(*this));
+        }
+        case Kind::BLOCK: {
+            return visitor(static_cast<BlockStatement&>(*this));
+        }
+        case Kind::MODULE: {
+            return visitor(static_cast<ModuleStatement&>(*this));
+        }
+        case Kind::FUNCTION: {
+            return visitor(static_cast<FunctionStatement&>(*this));
+        }
+        case Kind::IF: {
+            return visitor(static_cast<IfStatement&>(*this));
+        }
+        case Kind::RETURN: {
+            return visitor(static_cast<ReturnStatement&>(*this));
+        }
+        case Kind::VARIABLE: {
+            return visitor(static_cast<VariableStatement&>(*this));
+        }
+        case Kind::WHILE: {
+            return visitor(static_cast<WhileStatement&>(*this));
+        }
+        case Kind::FOR: {
+            return visitor(static_cast<ForStatement&>(*this));
+        }
+        case Kind::EXPRESSION: {
+            return visitor(static_cast<ExpressionStatement&>(*this));
+        }
+        case Kind::ARRAY: {
+            return visitor(static_cast<ArrayStatement&>(*this));
+        }
+        case Kind::STRUCT: {
+            return visitor(static_cast<StructStatement&>(*this));
+        }
+        case Kind::ENUM: {
+            return visitor(static_cast<EnumStatement&>(*this));
+        }
+        case Kind::MATCH: {
+            return visitor(static_cast<MatchStatement&>(*this));
+        }
+    }
+
+    std::unreachable();
+}
+
+template <typename Visitor>
+decltype(auto) Statement::visit(Visitor&& visitor) const
+{
+    switch (m_kind) {
+        case Kind::EMPTY: {
+            return visitor(static_cast<const EmptyStatement&>(*this));
+        }
+        case Kind::BLOCK: {
+            return visitor(static_cast<const BlockStatement&>(*this));
+        }
+        case Kind::MODULE: {
+            return visitor(static_cast<const ModuleStatement&>(*this));
+        }
+        case Kind::FUNCTION: {
+            return visitor(static_cast<const FunctionStatement&>(*this));
+        }
+        case Kind::IF: {
+            return visitor(static_cast<const IfStatement&>(*this));
+        }
+        case Kind::RETURN: {
+            return visitor(static_cast<const ReturnStatement&>(*this));
+        }
+        case Kind::VARIABLE: {
+            return visitor(static_cast<const VariableStatement&>(*this));
+        }
+        case Kind::WHILE: {
+            return visitor(static_cast<const WhileStatement&>(*this));
+        }
+        case Kind::FOR: {
+            return visitor(static_cast<const ForStatement&>(*this));
+        }
+        case Kind::EXPRESSION: {
+            return visitor(static_cast<const ExpressionStatement&>(*this));
+        }
+        case Kind::ARRAY: {
+            return visitor(static_cast<const ArrayStatement&>(*this));
+        }
+        case Kind::STRUCT: {
+            return visitor(static_cast<const StructStatement&>(*this));
+        }
+        case Kind::ENUM: {
+            return visitor(static_cast<const EnumStatement&>(*this));
+        }
+        case Kind::MATCH: {
+            return visitor(static_cast<const MatchStatement&>(*this));
+        }
+    }
+
+    std::unreachable();
+}
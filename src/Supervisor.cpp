@@ -1,91 +1,129 @@
 #include "Supervisor.hpp"
 
+#include <algorithm>
+#include <system_error>
 #include <utility>
 
-std::shared_ptr<Supervisor> Supervisor::create(std::string file_contents, std::string project_root_file) noexcept
+namespace
 {
-    return std::make_shared<Supervisor>(Supervisor(
-        std::move(file_contents), std::filesystem::path(std::move(project_root_file))));
+
+// Paths are shown the way gcc shows them, relative to where dl was run from
+[[nodiscard]] std::string display_name(const std::filesystem::path& path)
+{
+    std::error_code error;
+    auto            relative = std::filesystem::proximate(path, error);
+    return error ? path.string() : relative.string();
 }
 
-Supervisor::Supervisor(std::string&& file_contents, std::filesystem::path project_root) noexcept
-    : m_file_contents{file_contents},
+} // namespace
+
+std::shared_ptr<Supervisor> Supervisor::create(dts::MappedFile file_contents, std::string project_root_file) noexcept
+{
+    auto sources = std::make_shared<SourceTable>();
+    sources->files.emplace_back(std::move(file_contents), project_root_file);
+
+    return std::shared_ptr<Supervisor>(
+        new Supervisor(std::move(sources), std::filesystem::path(std::move(project_root_file))));
+}
+
+Supervisor::Supervisor(std::shared_ptr<SourceTable> sources, std::filesystem::path project_root) noexcept
+    : m_sources{std::move(sources)},
+      m_root_source{m_sources->files.front().contents.view()},
       m_project_root{std::move(project_root)}
 {
 }
 
+std::shared_ptr<Supervisor> Supervisor::create_module_supervisor() const noexcept
+{
+    return std::shared_ptr<Supervisor>(new Supervisor(m_sources, m_project_root));
+}
+
+Supervisor::SourceId Supervisor::store_source(dts::MappedFile contents, const std::filesystem::path& path) noexcept
+{
+    auto name = display_name(path);
+
+    // Elements of a deque stay in place while it grows, only the insertion
+    // itself needs the lock
+    std::scoped_lock lock(m_sources->mutex);
+    m_sources->files.emplace_back(std::move(contents), std::move(name));
+    return static_cast<SourceId>(m_sources->files.size() - 1);
+}
+
+std::string_view Supervisor::source(const SourceId id) const noexcept
+{
+    return source_file(id).contents.view();
+}
+
+const Supervisor::SourceFile& Supervisor::source_file(const SourceId id) const noexcept
+{
+    std::scoped_lock lock(m_sources->mutex);
+    return m_sources->files[id];
+}
+
 void Supervisor::push_error(const DLError& error) noexcept
 {
+    std::scoped_lock lock(m_errors_mutex);
     m_errors.push_back(error);
+    m_error_count.store(m_errors.size(), std::memory_order_relaxed);
 }
 
-void Supervisor::dump_errors() const
+void Supervisor::take_errors(Supervisor& other) noexcept
 {
-    for (const auto& error : m_errors) { print_error(error); }
+    if (&other == this) { return; }
 
-    m_errors.clear();
+    std::scoped_lock lock(m_errors_mutex, other.m_errors_mutex);
+    m_errors.insert(m_errors.end(), other.m_errors.begin(), other.m_errors.end());
+    m_error_count.store(m_errors.size(), std::memory_order_relaxed);
+
+    other.m_errors.clear();
+    other.m_error_count.store(0, std::memory_order_relaxed);
 }
 
-std::vector<Position> Supervisor::compute_line_positions() const noexcept
+void Supervisor::dump_errors() const
 {
-    std::vector<Position> line_positions;
-
-    std::size_t start = 0;
-    for (std::size_t i = 0; i < m_file_contents.size(); ++i) {
-        if (m_file_contents[i] == '\n') {
-            line_positions.push_back(Position::create(start, ++i));
-            start = i + 1;
-        }
-    }
+    std::scoped_lock lock(m_errors_mutex);
+    for (const auto& error : m_errors) { print_error(error); }
 
-    return line_positions;
+    m_errors.clear();
+    m_error_count.store(0, std::memory_order_relaxed);
 }
 
 void Supervisor::print_error(const DLError& error) const
 {
-    if (m_file_contents.empty()) { return; }
+    const auto& file          = source_file(error.position().source());
+    const auto  file_contents = file.contents.view();
 
     fmt::print(stderr, fmt::fg(fmt::color::red), "error");
     fmt::print(stderr, fmt::emphasis::bold, ": {}\n", error.message());
 
-    // Find in which line is present the error span
-    std::size_t error_line_index  = 0;
-    std::size_t error_line_number = 0;
-    const auto  line_positions    = compute_line_positions();
-    for (std::size_t line_index = 0; line_index < line_positions.size(); ++line_index) {
-        const auto& current_line_position = line_positions[line_index];
-        if (error.position().start() + 1 >= current_line_position.start() &&
-            error.position().start() + 1 <= current_line_position.end()) {
-            error_line_index = line_index;
+    std::call_once(file.line_starts_built, [&file, file_contents] {
+        file.line_starts.push_back(0);
+        for (std::size_t i = 0; i < file_contents.size(); ++i) {
+            if (file_contents[i] == '\n') { file.line_starts.push_back(i + 1); }
         }
-
-        if (error.position().end() + 1 >= current_line_position.start() &&
-            error.position().end() + 1 <= current_line_position.end()) {
-            error_line_number = line_index + 1;
-        }
-    }
-
-    fmt::println(stderr, " --> {}:{}", error_line_number, error.position().start() + 1);
+    });
+
+    // The line holding the start of the span is the last one starting at or
+    // before it
+    const auto start       = std::min(error.position().start(), file_contents.size());
+    const auto line_index  = static_cast<std::size_t>(
+        std::ranges::upper_bound(file.line_starts, start) - file.line_starts.begin() - 1);
+    const auto line_start  = file.line_starts[line_index];
+    const auto line_end    = std::min(file_contents.find('\n', line_start), file_contents.size());
+    const auto line_number = line_index + 1;
+
+    fmt::println(stderr, " --> {}:{}:{}", file.name, line_number, start - line_start + 1);
     fmt::println(stderr, "  |");
-    fmt::print(stderr, "  {} \t", error_line_number);
-
-    // Print error line contents
-    const auto& error_line_position = line_positions[error_line_index];
-    const auto  error_line_contents = m_file_contents.substr(
-        error_line_position.start(),
-        (error_line_position.end() - error_line_position.start()));
-    fmt::print(stderr, "{}", error_line_contents);
-
-    // Print '^^^^' below span and error message next
-    const auto spaces =
-        std::string(error.position().start() - error_line_position.start(), ' ');
-    const auto carets =
-        std::string(error.position().end() + 1 - error.position().start() + 1, '^');
+    fmt::println(stderr, "  {} \t{}", line_number, file_contents.substr(line_start, line_end - line_start));
+
+    // Print '^^^^' below the span, cut at the end of its first line, and the
+    // error message next
+    const auto end = std::clamp(error.position().end(), start + 1, std::max(line_end, start + 1));
     fmt::print(
         stderr,
         fmt::fg(fmt::color::red),
-        "  |    {}{} {}\n",
-        spaces,
-        carets,
+        "  |\t{}{} {}\n",
+        std::string(start - line_start, ' '),
+        std::string(end - start, '^'),
         error.message());
 }
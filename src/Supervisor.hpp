@@ -1,33 +1,86 @@
 #pragma once
 
+#include <atomic>
+#include <deque>
 #include <filesystem>
+#include <mutex>
+#include <string>
+#include <string_view>
 #include <vector>
 
 #include <fmt/color.h>
 #include <fmt/core.h>
 #include <fmt/format.h>
 
+#include <dtsutil/filesystem.hpp>
+
 #include "Error.hpp"
 
 class [[nodiscard]] Supervisor
 {
   public:
+    using SourceId = Position::SourceId;
+
+    // A source file of the compilation. The line-start table used to render
+    // diagnostics is only built the first time one points into the file.
+    struct SourceFile
+    {
+        SourceFile(dts::MappedFile file_contents, std::string file_name) noexcept
+            : contents{std::move(file_contents)},
+              name{std::move(file_name)}
+        {
+        }
+
+        dts::MappedFile                  contents;
+        std::string                      name;
+        mutable std::once_flag           line_starts_built;
+        mutable std::vector<std::size_t> line_starts;
+    };
+
+    static constexpr SourceId root_source_id = 0;
+
     [[nodiscard]] static std::shared_ptr<Supervisor>
-    create(std::string file_contents, std::string project_root_file) noexcept;
+    create(dts::MappedFile file_contents, std::string project_root_file) noexcept;
+
+    // A supervisor sharing this one's sources and project root but collecting
+    // its own diagnostics, so modules processed concurrently neither stop on
+    // nor interleave with each other's errors
+    [[nodiscard]] std::shared_ptr<Supervisor> create_module_supervisor() const noexcept;
+
+    // Takes ownership of a source buffer, whose view stays valid for the
+    // whole compilation as tokens point straight into it. Safe to call from
+    // several threads.
+    [[nodiscard]] SourceId store_source(dts::MappedFile contents, const std::filesystem::path& path) noexcept;
 
+    [[nodiscard]] std::string_view source(SourceId id) const noexcept;
+
+    [[nodiscard]] std::string_view root_source() const noexcept { return m_root_source; }
+
+    // Every source of the compilation, the root file first. Not to be used
+    // while other threads may still store sources.
+    [[nodiscard]] const std::deque<SourceFile>& sources() const noexcept
+    {
+        return m_sources->files;
+    }
+
+    // Safe to call from several threads
     void push_error(const DLError& error) noexcept;
 
     template <typename... Args>
     void push_error(Args&&... args) noexcept
     {
-        m_errors.push_back(DLError::create(std::forward<Args>(args)...));
+        const auto error = DLError::create(std::forward<Args>(args)...);
+        push_error(error);
     }
 
+    // Moves the diagnostics of `other` after this supervisor's own
+    void take_errors(Supervisor& other) noexcept;
+
     void dump_errors() const;
 
-    [[nodiscard]] constexpr bool has_errors() const noexcept
+    [[nodiscard]] bool has_errors() const noexcept
     {
-        return !m_errors.empty();
+        return m_error_count.load(std::memory_order_relaxed) != 0;
     }
 
     [[nodiscard]] constexpr const std::filesystem::path& project_root() const noexcept
@@ -36,13 +89,23 @@ class [[nodiscard]] Supervisor
     }
 
   private:
-    explicit Supervisor(std::string&& file_contents, std::filesystem::path project_root) noexcept;
+    struct SourceTable
+    {
+        std::mutex             mutex;
+        std::deque<SourceFile> files;
+    };
+
+    explicit Supervisor(
+        std::shared_ptr<SourceTable> sources, std::filesystem::path project_root) noexcept;
 
-    [[nodiscard]] std::vector<Position> compute_line_positions() const noexcept;
+    [[nodiscard]] const SourceFile& source_file(SourceId id) const noexcept;
 
     void print_error(const DLError& error) const;
 
-    mutable std::vector<DLError> m_errors;
-    std::string                  m_file_contents;
-    std::filesystem::path        m_project_root;
+    mutable std::mutex               m_errors_mutex;
+    mutable std::vector<DLError>     m_errors;
+    mutable std::atomic<std::size_t> m_error_count = 0;
+    std::shared_ptr<SourceTable>     m_sources;
+    std::string_view                 m_root_source;
+    std::filesystem::path            m_project_root;
 };
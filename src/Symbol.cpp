@@ -0,0 +1,139 @@
+#include "Symbol.hpp"
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+
+namespace
+{
+
+// Names are found by id in fixed-size chunks that never move once
+// allocated, so reading one back takes no lock
+constexpr std::size_t chunk_bits  = 12;
+constexpr std::size_t chunk_size  = std::size_t{1} << chunk_bits;
+constexpr std::size_t chunk_count = std::size_t{1} << 14;
+
+// Ids are looked up in shards picked by the name's hash, interning in one
+// only blocks the threads interning in that same shard
+constexpr std::size_t shard_count = 16;
+
+struct Shard
+{
+    std::shared_mutex                                mutex;
+    std::unordered_map<std::string_view, Symbol::Id> ids;
+};
+
+struct SymbolTable
+{
+    SymbolTable() noexcept { static_cast<void>(append(std::string_view{})); }
+
+    // Stores `name` under the next id. Only called with the name's shard
+    // locked, so a name is never appended twice.
+    [[nodiscard]] Symbol::Id append(const std::string_view name) noexcept
+    {
+        std::scoped_lock lock(append_mutex);
+
+        const auto id    = count.load(std::memory_order_relaxed);
+        const auto chunk = id >> chunk_bits;
+        if (chunk == chunk_count) { std::abort(); }
+
+        auto* entries = chunks[chunk].load(std::memory_order_relaxed);
+        if (entries == nullptr) {
+            entries = storage.emplace_back(std::make_unique<std::string_view[]>(chunk_size)).get();
+            chunks[chunk].store(entries, std::memory_order_relaxed);
+        }
+        entries[id & (chunk_size - 1)] = texts.emplace_back(name);
+
+        // Publishes the name along with the id
+        count.store(id + 1, std::memory_order_release);
+        return id;
+    }
+
+    [[nodiscard]] std::string_view name(const Symbol::Id id) const noexcept
+    {
+        // Pairs with the release in append(), every id handed out so far is
+        // below the count and its name visible
+        static_cast<void>(count.load(std::memory_order_acquire));
+        return chunks[id >> chunk_bits].load(std::memory_order_relaxed)[id & (chunk_size - 1)];
+    }
+
+    [[nodiscard]] Shard& shard(const std::string_view name) noexcept
+    {
+        return shards[std::hash<std::string_view>{}(name) % shard_count];
+    }
+
+    std::array<std::atomic<std::string_view*>, chunk_count> chunks{};
+    std::atomic<Symbol::Id>                                 count = 0;
+    std::array<Shard, shard_count>                          shards;
+
+    // Only touched when a new name is interned
+    std::mutex                                      append_mutex;
+    std::deque<std::unique_ptr<std::string_view[]>> storage;
+    std::deque<std::string>                         texts;
+};
+
+[[nodiscard]] SymbolTable& symbol_table() noexcept
+{
+    static SymbolTable table;
+    return table;
+}
+
+// Every name this thread interned or found, so a name seen again is found
+// without locking. Keys view into the table's texts.
+[[nodiscard]] std::unordered_map<std::string_view, Symbol::Id>& thread_cache() noexcept
+{
+    thread_local std::unordered_map<std::string_view, Symbol::Id> cache;
+    return cache;
+}
+
+} // namespace
+
+Symbol Symbol::intern(const std::string_view name) noexcept
+{
+    if (const auto symbol = find(name)) { return *symbol; }
+
+    auto&            table = symbol_table();
+    auto&            shard = table.shard(name);
+    std::unique_lock lock(shard.mutex);
+
+    // Another thread may have interned it between both locks
+    auto id = Id{0};
+    if (const auto found = shard.ids.find(name); found != shard.ids.end()) {
+        id = found->second;
+    } else {
+        id = table.append(name);
+        shard.ids.emplace(table.name(id), id);
+    }
+
+    thread_cache().emplace(table.name(id), id);
+    return Symbol(id);
+}
+
+std::optional<Symbol> Symbol::find(const std::string_view name) noexcept
+{
+    auto& cache = thread_cache();
+    if (const auto cached = cache.find(name); cached != cache.end()) { return Symbol(cached->second); }
+
+    auto&            table = symbol_table();
+    auto&            shard = table.shard(name);
+    std::shared_lock lock(shard.mutex);
+
+    if (const auto found = shard.ids.find(name); found != shard.ids.end()) {
+        cache.emplace(found->first, found->second);
+        return Symbol(found->second);
+    }
+    return {};
+}
+
+std::string_view Symbol::name() const noexcept
+{
+    return symbol_table().name(m_id);
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <string_view>
+
+#include <fmt/format.h>
+
+// An identifier interned in a table shared by the whole compilation. Every
+// distinct name is stored once and a Symbol is only its 32-bit index, so
+// copying, hashing and comparing symbols never touches the characters.
+// Interning and looking names up is safe from several threads: reading a
+// name back never locks, and neither does interning a name the calling
+// thread has seen before.
+class [[nodiscard]] Symbol
+{
+  public:
+    using Id = std::uint32_t;
+
+    // The empty name, always interned as id 0
+    constexpr Symbol() noexcept = default;
+
+    [[nodiscard]] static Symbol intern(std::string_view name) noexcept;
+
+    // The symbol of `name` if it was interned before, without interning it
+    [[nodiscard]] static std::optional<Symbol> find(std::string_view name) noexcept;
+
+    // Stays valid for the whole compilation
+    [[nodiscard]] std::string_view name() const noexcept;
+
+    [[nodiscard]] constexpr Id id() const noexcept { return m_id; }
+
+    [[nodiscard]] constexpr bool empty() const noexcept { return m_id == 0; }
+
+    friend constexpr bool operator==(Symbol lhs, Symbol rhs) noexcept = default;
+
+  private:
+    constexpr explicit Symbol(const Id id) noexcept : m_id{id} {}
+
+    Id m_id = 0;
+};
+
+template <>
+struct std::hash<Symbol>
+{
+    std::size_t operator()(const Symbol symbol) const noexcept { return symbol.id(); }
+};
+
+// {fmt} formatters
+template <>
+struct fmt::formatter<Symbol> : fmt::formatter<std::string_view>
+{
+    template <typename FormatContext>
+    auto format(const Symbol symbol, FormatContext& ctx)
+    {
+        return fmt::formatter<std::string_view>::format(symbol.name(), ctx);
+    }
+};
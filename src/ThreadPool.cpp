@@ -0,0 +1,48 @@
+#include "ThreadPool.hpp"
+
+#include <algorithm>
+#include <utility>
+
+ThreadPool::ThreadPool(const std::size_t thread_count)
+{
+    m_workers.reserve(thread_count);
+    for (std::size_t i = 0; i < std::max<std::size_t>(thread_count, 1); ++i) {
+        m_workers.emplace_back([this](const std::stop_token& stop_token) { work(stop_token); });
+    }
+}
+
+void ThreadPool::submit(std::function<void()> task)
+{
+    {
+        std::scoped_lock lock(m_mutex);
+        m_tasks.push_back(std::move(task));
+    }
+    m_task_available.notify_one();
+}
+
+void ThreadPool::wait() noexcept
+{
+    std::unique_lock lock(m_mutex);
+    m_idle.wait(lock, [this] { return m_tasks.empty() && m_running == 0; });
+}
+
+std::size_t ThreadPool::default_thread_count() noexcept
+{
+    return std::max(std::thread::hardware_concurrency(), 1U);
+}
+
+void ThreadPool::work(const std::stop_token& stop_token) noexcept
+{
+    std::unique_lock lock(m_mutex);
+    while (m_task_available.wait(lock, stop_token, [this] { return !m_tasks.empty(); })) {
+        auto task = std::move(m_tasks.front());
+        m_tasks.pop_front();
+        ++m_running;
+
+        lock.unlock();
+        task();
+        lock.lock();
+
+        if (--m_running == 0 && m_tasks.empty()) { m_idle.notify_all(); }
+    }
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <stop_token>
+#include <thread>
+#include <vector>
+
+// Fixed set of worker threads running submitted tasks in submission order.
+// Tasks may submit further tasks, wait() returns once the queue is drained
+// and every worker is idle.
+class [[nodiscard]] ThreadPool
+{
+  public:
+    explicit ThreadPool(std::size_t thread_count);
+
+    ThreadPool(const ThreadPool&) = delete;
+
+    ThreadPool(ThreadPool&&) = delete;
+
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    ThreadPool& operator=(ThreadPool&&) = delete;
+
+    void submit(std::function<void()> task);
+
+    void wait() noexcept;
+
+    // One thread per hardware thread, at least one
+    [[nodiscard]] static std::size_t default_thread_count() noexcept;
+
+  private:
+    void work(const std::stop_token& stop_token) noexcept;
+
+    std::mutex                        m_mutex;
+    std::condition_variable_any       m_task_available;
+    std::condition_variable           m_idle;
+    std::deque<std::function<void()>> m_tasks;
+    std::size_t                       m_running = 0;
+
+    // Last, so the workers are stopped and joined before anything they use
+    // is destroyed
+    std::vector<std::jthread> m_workers;
+};
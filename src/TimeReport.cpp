@@ -0,0 +1,197 @@
+#include "TimeReport.hpp"
+
+#include <array>
+#include <atomic>
+#include <cstdlib>
+#include <mutex>
+#include <new>
+#include <string>
+#include <string_view>
+
+#include <fmt/format.h>
+
+namespace
+{
+
+struct PhaseTotals
+{
+    std::chrono::nanoseconds wall_time{0};
+    std::uint64_t            entries     = 0;
+    std::uint64_t            bytes       = 0;
+    std::uint64_t            items       = 0;
+    std::uint64_t            allocations = 0;
+};
+
+struct PhaseInfo
+{
+    std::string_view name;
+    std::string_view item_name;
+};
+
+constexpr std::array<PhaseInfo, TimeReport::phase_count> phase_infos = {{
+    {"read", ""},
+    {"lex", "tokens"},
+    {"parse", "nodes"},
+    {"typecheck", ""},
+    {"fold", "nodes"},
+    {"eliminate", "declarations"},
+    {"codegen", "modules"},
+    {"write", ""},
+    {"cache", ""},
+    {"compile", "processes"},
+    {"link", ""},
+    {"cleanup", ""},
+}};
+
+std::atomic<bool>                               report_enabled = false;
+std::chrono::steady_clock::time_point           report_start;
+std::mutex                                      totals_mutex;
+std::array<PhaseTotals, TimeReport::phase_count> totals;
+
+#ifdef DL_COUNT_ALLOCATIONS
+thread_local std::uint64_t allocation_count = 0;
+#endif
+
+[[nodiscard]] double milliseconds(const std::chrono::nanoseconds duration) noexcept
+{
+    return std::chrono::duration<double, std::milli>(duration).count();
+}
+
+} // namespace
+
+#ifdef DL_COUNT_ALLOCATIONS
+// Counting every allocation is what makes the per-phase allocation numbers
+// possible, it costs a thread-local increment whether or not a report is made
+void* operator new(const std::size_t size)
+{
+    ++allocation_count;
+    if (auto* pointer = std::malloc(size == 0 ? 1 : size)) { return pointer; }
+    throw std::bad_alloc();
+}
+
+void* operator new(const std::size_t size, const std::align_val_t alignment)
+{
+    ++allocation_count;
+    const auto align = static_cast<std::size_t>(alignment);
+    if (auto* pointer = std::aligned_alloc(align, (size + align - 1) / align * align)) {
+        return pointer;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* pointer) noexcept { std::free(pointer); }
+
+void operator delete(void* pointer, std::size_t) noexcept { std::free(pointer); }
+
+void operator delete(void* pointer, std::align_val_t) noexcept { std::free(pointer); }
+
+void operator delete(void* pointer, std::size_t, std::align_val_t) noexcept { std::free(pointer); }
+#endif
+
+void TimeReport::enable() noexcept
+{
+    report_start = std::chrono::steady_clock::now();
+    report_enabled.store(true, std::memory_order_relaxed);
+}
+
+bool TimeReport::enabled() noexcept
+{
+    return report_enabled.load(std::memory_order_relaxed);
+}
+
+std::string_view TimeReport::phase_name(const Phase phase) noexcept
+{
+    return phase_infos[static_cast<std::size_t>(phase)].name;
+}
+
+void TimeReport::record(
+    const Phase                    phase,
+    const std::chrono::nanoseconds wall_time,
+    const std::uint64_t            bytes,
+    const std::uint64_t            items,
+    const std::uint64_t            allocations) noexcept
+{
+    std::scoped_lock lock(totals_mutex);
+
+    auto& phase_totals = totals[static_cast<std::size_t>(phase)];
+    phase_totals.wall_time += wall_time;
+    phase_totals.entries += 1;
+    phase_totals.bytes += bytes;
+    phase_totals.items += items;
+    phase_totals.allocations += allocations;
+}
+
+void TimeReport::print(std::FILE* output)
+{
+    const auto total_time = std::chrono::steady_clock::now() - report_start;
+
+    std::scoped_lock lock(totals_mutex);
+
+    fmt::print(
+        output,
+        "{:<10} {:>12} {:>8} {:>14} {:>20} {:>12}\n",
+        "phase",
+        "wall (ms)",
+        "entries",
+        "bytes",
+        "items",
+        "allocations");
+
+    // Phases of different threads overlap, so they may add up to more than
+    // the total
+    for (std::size_t i = 0; i < totals.size(); ++i) {
+        const auto& phase_totals = totals[i];
+        if (phase_totals.entries == 0) { continue; }
+
+        const auto items = phase_infos[i].item_name.empty()
+                               ? std::string()
+                               : fmt::format("{} {}", phase_totals.items, phase_infos[i].item_name);
+        const auto allocations = TimeReport::counts_allocations
+                                     ? fmt::format("{}", phase_totals.allocations)
+                                     : std::string("-");
+        fmt::print(
+            output,
+            "{:<10} {:>12.3f} {:>8} {:>14} {:>20} {:>12}\n",
+            phase_infos[i].name,
+            milliseconds(phase_totals.wall_time),
+            phase_totals.entries,
+            phase_totals.bytes,
+            items,
+            allocations);
+    }
+
+    fmt::print(output, "{:<10} {:>12.3f}\n", "total", milliseconds(total_time));
+}
+
+std::uint64_t TimeReport::thread_allocations() noexcept
+{
+#ifdef DL_COUNT_ALLOCATIONS
+    return allocation_count;
+#else
+    return 0;
+#endif
+}
+
+ScopedTimer::ScopedTimer(const TimeReport::Phase phase, const std::string_view detail) noexcept
+    : m_span{TimeReport::phase_name(phase), detail},
+      m_phase{phase},
+      m_enabled{TimeReport::enabled()}
+{
+    if (!m_enabled) { return; }
+
+    m_start_allocations = TimeReport::thread_allocations();
+    m_start             = std::chrono::steady_clock::now();
+}
+
+ScopedTimer::~ScopedTimer() noexcept
+{
+    if (!m_enabled) { return; }
+
+    const auto wall_time = std::chrono::steady_clock::now() - m_start;
+    TimeReport::record(
+        m_phase,
+        std::chrono::duration_cast<std::chrono::nanoseconds>(wall_time),
+        m_bytes,
+        m_items,
+        TimeReport::thread_allocations() - m_start_allocations);
+}
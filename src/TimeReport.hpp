@@ -0,0 +1,97 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <string_view>
+
+#include "Trace.hpp"
+
+// Per-phase wall time, volume and allocation counts of a dl invocation,
+// printed by --time-report. Phases instrument themselves with a
+// ScopedTimer; a phase entered several times, possibly from several threads,
+// adds up. While the report is disabled timers cost a single flag check.
+//
+// Allocations are only counted in builds configured with
+// -DDL_COUNT_ALLOCATIONS=ON. Those replace the global operator new, so every
+// allocation of the process pays a thread-local increment even when no
+// report is requested.
+class [[nodiscard]] TimeReport
+{
+  public:
+    enum class Phase : std::uint8_t
+    {
+        READ,
+        LEX,
+        PARSE,
+        TYPECHECK,
+        FOLD,
+        ELIMINATE,
+        CODEGEN,
+        WRITE,
+        CACHE,
+        COMPILE,
+        LINK,
+        CLEANUP,
+    };
+
+    static constexpr std::size_t phase_count = static_cast<std::size_t>(Phase::CLEANUP) + 1;
+
+    // Starts measuring, the total wall time runs from here
+    static void enable() noexcept;
+
+    [[nodiscard]] static bool enabled() noexcept;
+
+    [[nodiscard]] static std::string_view phase_name(Phase phase) noexcept;
+
+    static void record(
+        Phase                    phase,
+        std::chrono::nanoseconds wall_time,
+        std::uint64_t            bytes,
+        std::uint64_t            items,
+        std::uint64_t            allocations) noexcept;
+
+    static void print(std::FILE* output);
+
+#ifdef DL_COUNT_ALLOCATIONS
+    static constexpr bool counts_allocations = true;
+#else
+    static constexpr bool counts_allocations = false;
+#endif
+
+    // Heap allocations made so far by the calling thread, always 0 unless
+    // allocations are counted
+    [[nodiscard]] static std::uint64_t thread_allocations() noexcept;
+};
+
+// Measures its own lifetime as one entry of `phase`. Bytes and items (tokens,
+// nodes, modules... depending on the phase) are added by the code measured.
+// The same lifetime is traced as a span of the phase, named after `detail`.
+class [[nodiscard]] ScopedTimer
+{
+  public:
+    explicit ScopedTimer(TimeReport::Phase phase, std::string_view detail = {}) noexcept;
+
+    ~ScopedTimer() noexcept;
+
+    ScopedTimer(const ScopedTimer&) = delete;
+
+    ScopedTimer(ScopedTimer&&) = delete;
+
+    ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+    ScopedTimer& operator=(ScopedTimer&&) = delete;
+
+    void add_bytes(const std::uint64_t bytes) noexcept { m_bytes += bytes; }
+
+    void add_items(const std::uint64_t items) noexcept { m_items += items; }
+
+  private:
+    TraceSpan                             m_span;
+    TimeReport::Phase                     m_phase;
+    bool                                  m_enabled;
+    std::chrono::steady_clock::time_point m_start;
+    std::uint64_t                         m_start_allocations = 0;
+    std::uint64_t                         m_bytes             = 0;
+    std::uint64_t                         m_items             = 0;
+};
@@ -1,8 +1,8 @@
 #include "Token.hpp"
 
-[[nodiscard]] Token Token::create(Type type, std::string lexeme, Position position) noexcept
+[[nodiscard]] Token Token::create(Type type, std::string_view lexeme, Position position) noexcept
 {
-    return Token{type, std::move(lexeme), position};
+    return Token{type, lexeme, position};
 }
 
 [[nodiscard]] Token Token::create_dumb() noexcept
@@ -10,9 +10,9 @@
     return Token::create(Type::END_OF_FILE, "", Position::create_dumb());
 }
 
-Token::Token(Token::Type type, std::string lexeme, Position position) noexcept
-    : m_type{type},
-      m_lexeme{std::move(lexeme)},
-      m_position(position)
+Token::Token(Token::Type type, std::string_view lexeme, Position position) noexcept
+    : m_lexeme{lexeme},
+      m_position(position),
+      m_type{type}
 {
 }
@@ -1,11 +1,14 @@
 #pragma once
 
+#include <algorithm>
 #include <array>
 #include <cstdint>
 #include <optional>
 #include <ranges>
 #include <sstream>
 #include <string>
+#include <string_view>
+#include <utility>
 
 #include <fmt/format.h>
 
@@ -88,13 +91,14 @@ class [[nodiscard]] Token
         MAX,
     };
 
-    [[nodiscard]] static Token create(Type type, std::string lexeme, Position position) noexcept;
+    [[nodiscard]] static Token create(Type type, std::string_view lexeme, Position position) noexcept;
 
     [[nodiscard]] static Token create_dumb() noexcept;
 
     [[nodiscard]] constexpr Type type() const noexcept { return m_type; }
 
-    [[nodiscard]] constexpr std::string lexeme() const noexcept
+    // The lexeme is a view into the source buffer owned by the Supervisor
+    [[nodiscard]] constexpr std::string_view lexeme() const noexcept
     {
         return m_lexeme;
     }
@@ -106,25 +110,38 @@ class [[nodiscard]] Token
         return m_type == rhs_type;
     }
 
-    [[nodiscard]] constexpr static std::optional<Type> is_keyword(const std::string& lexeme) noexcept
+    // Keywords are looked up through a perfect hash over the first character,
+    // the last character and the length, so recognising one costs a hash and
+    // a single compare. The lookup table is generated at compile time from
+    // this list and a static_assert below the class rejects any collision.
+    static constexpr std::array<std::pair<std::string_view, Type>, 17> keywords = {{
+        {"fn", Type::FN},
+        {"if", Type::IF},
+        {"mut", Type::MUT},
+        {"return", Type::RETURN},
+        {"while", Type::WHILE},
+        {"for", Type::FOR},
+        {"include", Type::C_INCLUDE},
+        {"struct", Type::STRUCT},
+        {"true", Type::TRUE},
+        {"false", Type::FALSE},
+        {"class", Type::CLASS},
+        {"and", Type::AND},
+        {"or", Type::OR},
+        {"enum", Type::ENUM},
+        {"match", Type::MATCH},
+        {"module", Type::MODULE},
+        {"import", Type::IMPORT},
+    }};
+
+    [[nodiscard]] constexpr static std::optional<Type> is_keyword(const std::string_view lexeme) noexcept
     {
-        if (lexeme == "fn") { return Type::FN; }
-        if (lexeme == "if") { return Type::IF; }
-        if (lexeme == "mut") { return Type::MUT; }
-        if (lexeme == "return") { return Type::RETURN; }
-        if (lexeme == "while") { return Type::WHILE; }
-        if (lexeme == "for") { return Type::FOR; }
-        if (lexeme == "include") { return Type::C_INCLUDE; }
-        if (lexeme == "struct") { return Type::STRUCT; }
-        if (lexeme == "true") { return Type::TRUE; }
-        if (lexeme == "false") { return Type::FALSE; }
-        if (lexeme == "class") { return Type::CLASS; }
-        if (lexeme == "and") { return Type::AND; }
-        if (lexeme == "or") { return Type::OR; }
-        if (lexeme == "enum") { return Type::ENUM; }
-        if (lexeme == "match") { return Type::MATCH; }
-        if (lexeme == "module") { return Type::MODULE; }
-        if (lexeme == "import") { return Type::IMPORT; }
+        if (lexeme.size() < min_keyword_length || lexeme.size() > max_keyword_length) {
+            return {};
+        }
+
+        const auto& [keyword, type] = keyword_table[keyword_hash(lexeme)];
+        if (keyword == lexeme) { return type; }
         return {};
     }
 
@@ -249,6 +266,9 @@ class [[nodiscard]] Token
             case Type::ARROW: {
                 return "->";
             }
+            case Type::DOT: {
+                return ".";
+            }
             case Type::MINUS_MINUS: {
                 return "--";
             }
@@ -373,13 +393,54 @@ class [[nodiscard]] Token
     }
 
   private:
-    Token(Type type, std::string lexeme, Position position) noexcept;
+    static constexpr std::size_t keyword_table_size = 64;
+    static constexpr auto keyword_length = [](const auto& entry) { return entry.first.size(); };
+    static constexpr std::size_t min_keyword_length =
+        keyword_length(std::ranges::min(keywords, {}, keyword_length));
+    static constexpr std::size_t max_keyword_length =
+        keyword_length(std::ranges::max(keywords, {}, keyword_length));
+
+    using KeywordTable =
+        std::array<std::pair<std::string_view, Type>, keyword_table_size>;
 
-    Type        m_type;
-    std::string m_lexeme;
-    Position    m_position;
+    [[nodiscard]] constexpr static std::size_t keyword_hash(const std::string_view lexeme) noexcept
+    {
+        const auto first = static_cast<unsigned char>(lexeme.front());
+        const auto last  = static_cast<unsigned char>(lexeme.back());
+        return (first + 3 * static_cast<std::size_t>(last) + lexeme.size()) &
+               (keyword_table_size - 1);
+    }
+
+    [[nodiscard]] constexpr static KeywordTable make_keyword_table() noexcept
+    {
+        KeywordTable table{};
+        table.fill({std::string_view{}, Type::MAX});
+        for (const auto& entry : keywords) { table[keyword_hash(entry.first)] = entry; }
+        return table;
+    }
+
+    static const KeywordTable keyword_table;
+
+    Token(Type type, std::string_view lexeme, Position position) noexcept;
+
+    // Largest first, so the type fits in the padding after the position
+    std::string_view m_lexeme;
+    Position         m_position;
+    Type             m_type;
 };
 
+constexpr Token::KeywordTable Token::keyword_table = Token::make_keyword_table();
+
+static_assert(sizeof(Token) <= 32, "Tokens are copied around by value, keep them small.");
+
+static_assert(
+    std::ranges::all_of(
+        Token::keywords,
+        [](const auto& entry) {
+            return Token::is_keyword(entry.first) == entry.second;
+        }),
+    "Token::keyword_hash must be collision-free over the keyword list.");
+
 // {fmt} formatters
 template <>
 struct fmt::formatter<Token::Type>
@@ -0,0 +1,139 @@
+#include "Trace.hpp"
+
+#include <unistd.h>
+
+#include <atomic>
+#include <fstream>
+#include <iterator>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include <fmt/format.h>
+
+namespace
+{
+
+struct Event
+{
+    std::string                           name;
+    std::string_view                      category;
+    std::chrono::steady_clock::time_point start;
+    std::chrono::steady_clock::time_point end;
+    std::uint32_t                         thread_id;
+};
+
+std::atomic<bool>                     trace_enabled = false;
+std::chrono::steady_clock::time_point trace_start;
+std::atomic<std::uint32_t>            next_thread_id = 0;
+std::mutex                            events_mutex;
+std::vector<Event>                    events;
+
+[[nodiscard]] std::uint32_t current_thread_id() noexcept
+{
+    thread_local const auto thread_id = next_thread_id++;
+    return thread_id;
+}
+
+[[nodiscard]] double microseconds(const std::chrono::steady_clock::duration duration) noexcept
+{
+    return std::chrono::duration<double, std::micro>(duration).count();
+}
+
+void append_json_string(fmt::memory_buffer& out, const std::string_view text)
+{
+    out.push_back('"');
+    for (const auto ch : text) {
+        if (ch == '"' || ch == '\\') {
+            out.push_back('\\');
+            out.push_back(ch);
+        } else if (static_cast<unsigned char>(ch) < 0x20) {
+            fmt::format_to(std::back_inserter(out), "\\u{:04x}", static_cast<unsigned>(ch));
+        } else {
+            out.push_back(ch);
+        }
+    }
+    out.push_back('"');
+}
+
+} // namespace
+
+void Trace::enable() noexcept
+{
+    trace_start = std::chrono::steady_clock::now();
+
+    // The enabling thread, main, becomes thread 0
+    static_cast<void>(current_thread_id());
+    trace_enabled.store(true, std::memory_order_relaxed);
+}
+
+bool Trace::enabled() noexcept
+{
+    return trace_enabled.load(std::memory_order_relaxed);
+}
+
+void Trace::record(
+    std::string                                 name,
+    const std::string_view                      category,
+    const std::chrono::steady_clock::time_point start,
+    const std::chrono::steady_clock::time_point end) noexcept
+{
+    const auto thread_id = current_thread_id();
+
+    std::scoped_lock lock(events_mutex);
+    events.push_back(Event{
+        .name      = std::move(name),
+        .category  = category,
+        .start     = start,
+        .end       = end,
+        .thread_id = thread_id,
+    });
+}
+
+bool Trace::write(const std::filesystem::path& path)
+{
+    std::scoped_lock lock(events_mutex);
+
+    const auto process_id = getpid();
+
+    fmt::memory_buffer out;
+    out.append(std::string_view("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n"));
+    for (std::size_t i = 0; i < events.size(); ++i) {
+        const auto& event = events[i];
+
+        out.append(std::string_view("{\"name\":"));
+        append_json_string(out, event.name);
+        out.append(std::string_view(",\"cat\":"));
+        append_json_string(out, event.category);
+        fmt::format_to(
+            std::back_inserter(out),
+            ",\"ph\":\"X\",\"ts\":{:.3f},\"dur\":{:.3f},\"pid\":{},\"tid\":{}}}{}\n",
+            microseconds(event.start - trace_start),
+            microseconds(event.end - event.start),
+            process_id,
+            event.thread_id,
+            i + 1 == events.size() ? "" : ",");
+    }
+    out.append(std::string_view("]}\n"));
+
+    std::ofstream file(path, std::ios::binary);
+    file.write(out.data(), static_cast<std::streamsize>(out.size()));
+    return file.good();
+}
+
+TraceSpan::TraceSpan(const std::string_view category, const std::string_view detail) noexcept
+    : m_enabled{Trace::enabled()},
+      m_category{category}
+{
+    if (!m_enabled) { return; }
+
+    m_name = detail.empty() ? std::string(category) : fmt::format("{} {}", category, detail);
+    m_start = std::chrono::steady_clock::now();
+}
+
+TraceSpan::~TraceSpan() noexcept
+{
+    if (!m_enabled) { return; }
+
+    Trace::record(std::move(m_name), m_category, m_start, std::chrono::steady_clock::now());
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <string_view>
+
+// Chrome trace-event recording, written by --trace-out and viewable in
+// chrome://tracing or Perfetto. Every span is a complete ("X") event on the
+// thread that ran it; threads are numbered in the order they first record
+// a span, the main thread being 0. While tracing is disabled spans cost a
+// single flag check.
+class [[nodiscard]] Trace
+{
+  public:
+    // Starts recording, timestamps run from here
+    static void enable() noexcept;
+
+    [[nodiscard]] static bool enabled() noexcept;
+
+    static void record(
+        std::string                           name,
+        std::string_view                      category,
+        std::chrono::steady_clock::time_point start,
+        std::chrono::steady_clock::time_point end) noexcept;
+
+    // Writes every span recorded so far as trace-event JSON
+    [[nodiscard]] static bool write(const std::filesystem::path& path);
+};
+
+// Records its own lifetime as a span named after `category` and `detail`,
+// e.g. "parse greetings.dl". The name is only built while tracing, the
+// category is kept as is and has to be a string literal.
+class [[nodiscard]] TraceSpan
+{
+  public:
+    explicit TraceSpan(std::string_view category, std::string_view detail = {}) noexcept;
+
+    ~TraceSpan() noexcept;
+
+    TraceSpan(const TraceSpan&) = delete;
+
+    TraceSpan(TraceSpan&&) = delete;
+
+    TraceSpan& operator=(const TraceSpan&) = delete;
+
+    TraceSpan& operator=(TraceSpan&&) = delete;
+
+  private:
+    bool                                  m_enabled;
+    std::string_view                      m_category;
+    std::string                           m_name;
+    std::chrono::steady_clock::time_point m_start;
+};
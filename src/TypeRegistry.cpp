@@ -0,0 +1,19 @@
+#include "TypeRegistry.hpp"
+
+void TypeRegistry::add(const Typechecker::CustomType& type, Statement* statement) noexcept
+{
+    m_types.try_emplace(type.name, Entry{.type = type, .statement = statement});
+}
+
+const TypeRegistry::Entry* TypeRegistry::find(const Symbol name) const noexcept
+{
+    const auto found = m_types.find(name);
+    return found != m_types.end() ? &found->second : nullptr;
+}
+
+const TypeRegistry::Entry* TypeRegistry::find(const std::string_view name) const noexcept
+{
+    // A name that was never interned cannot belong to a custom type
+    const auto symbol = Symbol::find(name);
+    return symbol ? find(*symbol) : nullptr;
+}
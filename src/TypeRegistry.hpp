@@ -0,0 +1,32 @@
+#pragma once
+
+#include <string_view>
+#include <unordered_map>
+
+#include "Symbol.hpp"
+#include "Typechecker.hpp"
+
+class Statement;
+
+// The structs and enums a module defines, keyed by name, so resolving a type
+// is one hash probe however many custom types the program has
+class [[nodiscard]] TypeRegistry
+{
+  public:
+    struct [[nodiscard]] Entry
+    {
+        Typechecker::CustomType type;
+        Statement*              statement;
+    };
+
+    // The first definition of a name wins, later ones are ignored
+    void add(const Typechecker::CustomType& type, Statement* statement) noexcept;
+
+    // The custom type named `name`, valid as long as the registry
+    [[nodiscard]] const Entry* find(Symbol name) const noexcept;
+
+    [[nodiscard]] const Entry* find(std::string_view name) const noexcept;
+
+  private:
+    std::unordered_map<Symbol, Entry> m_types;
+};
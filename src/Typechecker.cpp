@@ -1 +1,898 @@
 #include "Typechecker.hpp"
+
+#include <algorithm>
+#include <charconv>
+#include <limits>
+#include <string>
+#include <unordered_map>
+
+#include <fmt/format.h>
+
+#include "Environment.hpp"
+#include "Expression.hpp"
+#include "Statement.hpp"
+#include "Supervisor.hpp"
+#include "TypeRegistry.hpp"
+
+namespace
+{
+
+using ExpressionType = Typechecker::ExpressionType;
+using BuiltinType    = Typechecker::BuiltinType;
+using Category       = ExpressionType::Category;
+
+// Integer literals take the narrowest of i32, i64 and u64 holding them
+[[nodiscard]] ExpressionType integer_literal_type(const std::string_view literal) noexcept
+{
+    std::uint64_t value = 0;
+
+    const auto [end, error] = std::from_chars(literal.data(), literal.data() + literal.size(), value);
+    if (error != std::errc{} || value > std::numeric_limits<std::int64_t>::max()) {
+        return ExpressionType::builtin(BuiltinType::U64);
+    }
+    if (value > std::numeric_limits<std::int32_t>::max()) {
+        return ExpressionType::builtin(BuiltinType::I64);
+    }
+    return ExpressionType::builtin(BuiltinType::I32);
+}
+
+// Pointers only convert into pointers to the same type, i8 and char being
+// the same C type
+[[nodiscard]] bool same_pointee(const ExpressionType& lhs, const ExpressionType& rhs) noexcept
+{
+    if (lhs.category != rhs.category) { return false; }
+    if (lhs.category == Category::CUSTOM) { return lhs.custom_type.name == rhs.custom_type.name; }
+    if (lhs.category == Category::BUILTIN) {
+        return Typechecker::builtin_type_to_c_type(lhs.builtin_type) ==
+               Typechecker::builtin_type_to_c_type(rhs.builtin_type);
+    }
+    return true;
+}
+
+// A literal zero converts into any pointer, as in C
+[[nodiscard]] bool is_null_pointer_constant(const Expression* expression) noexcept
+{
+    const auto* literal = expression != nullptr ? expression->as<LiteralExpression>() : nullptr;
+    return literal != nullptr && literal->literal_type() == Token::Type::NUMBER &&
+           literal->literal().find_first_not_of('0') == std::string::npos;
+}
+
+// `value_expression` is the expression of type `value`, when there is one
+[[nodiscard]] bool is_assignable(
+    const ExpressionType& target, const ExpressionType& value, const Expression* value_expression) noexcept
+{
+    if (!target.is_known() || !value.is_known()) { return true; }
+    if (target.category == Category::VOID || value.category == Category::VOID) { return false; }
+
+    if (target.is_pointer() && is_null_pointer_constant(value_expression)) { return true; }
+    if (target.is_pointer() || value.is_pointer()) {
+        return target.indirection == value.indirection && same_pointee(target, value);
+    }
+
+    if (target.category == Category::CUSTOM || value.category == Category::CUSTOM) {
+        return target.category == value.category && target.custom_type.name == value.custom_type.name;
+    }
+
+    // Numbers and booleans convert into each other implicitly
+    return true;
+}
+
+[[nodiscard]] bool is_non_scalar(const ExpressionType& type) noexcept
+{
+    return type.is_known() && !type.is_scalar();
+}
+
+class [[nodiscard]] Checker
+{
+  public:
+    explicit Checker(const std::shared_ptr<Supervisor>& supervisor) noexcept
+        : m_supervisor{supervisor}
+    {
+    }
+
+    void check(const std::span<ModuleStatement* const> modules) noexcept
+    {
+        // Modules may use every type and function of the modules they import,
+        // so all of them are declared before any body is checked
+        for (const auto* modul : modules) { declare(*modul); }
+        for (const auto* modul : modules) {
+            for (auto* function : modul->functions().data()) {
+                check_function(*function->as<FunctionStatement>());
+            }
+        }
+    }
+
+  private:
+    void declare(const ModuleStatement& modul) noexcept
+    {
+        for (auto* statement : modul.structs().data()) {
+            const auto* struct_statement = statement->as<StructStatement>();
+            m_types.add(
+                Typechecker::CustomType(Symbol::intern(struct_statement->name()), Token::Type::STRUCT),
+                statement);
+        }
+        for (auto* statement : modul.enums().data()) {
+            const auto* enum_statement = statement->as<EnumStatement>();
+            m_types.add(
+                Typechecker::CustomType(Symbol::intern(enum_statement->name()), Token::Type::ENUM),
+                statement);
+        }
+        for (const auto* statement : modul.functions().data()) {
+            const auto* function = statement->as<FunctionStatement>();
+            m_functions.try_emplace(Symbol::intern(function->name()), function);
+        }
+    }
+
+    // Return types are kept as written, "Matrix*" for instance, and default
+    // to "void"
+    [[nodiscard]] ExpressionType return_type(const FunctionStatement& function) const noexcept
+    {
+        std::string_view written = function.return_type();
+        if (written == "void") { return ExpressionType::void_type(); }
+
+        std::uint8_t indirection = 0;
+        while (!written.empty() && written.back() == '*') {
+            written.remove_suffix(1);
+            ++indirection;
+        }
+
+        if (const auto builtin = Typechecker::builtin_type_from_string(written);
+            builtin != BuiltinType::NONE) {
+            return ExpressionType::builtin(builtin, indirection);
+        }
+        if (const auto* custom_type = m_types.find(written)) {
+            return ExpressionType::custom(custom_type->type, indirection);
+        }
+        return ExpressionType::unknown();
+    }
+
+    void error(std::string message, const Position position) noexcept
+    {
+        m_supervisor->push_error(std::move(message), position);
+    }
+
+    // Statements
+
+    void check_function(const FunctionStatement& function) noexcept
+    {
+        m_function    = &function;
+        m_return_type = return_type(function);
+
+        m_environment.clear();
+        m_environment.enter_scope();
+        for (const auto& arg : function.args()) { m_environment.enscope(arg); }
+        check_block(function.body());
+        m_environment.exit_scope();
+    }
+
+    void check_block(const BlockStatement& block) noexcept
+    {
+        m_environment.enter_scope();
+        for (auto* statement : block.data()) { check_statement(statement); }
+        m_environment.exit_scope();
+    }
+
+    void check_statement(Statement* statement) noexcept
+    {
+        if (statement == nullptr) { return; }
+        statement->visit([this](auto& node) { check(node); });
+    }
+
+    void check([[maybe_unused]] const EmptyStatement& statement) noexcept {}
+
+    void check([[maybe_unused]] const ModuleStatement& statement) noexcept {}
+
+    void check([[maybe_unused]] const FunctionStatement& statement) noexcept {}
+
+    void check([[maybe_unused]] const StructStatement& statement) noexcept {}
+
+    void check([[maybe_unused]] const EnumStatement& statement) noexcept {}
+
+    void check(const BlockStatement& statement) noexcept { check_block(statement); }
+
+    void check(const IfStatement& statement) noexcept
+    {
+        check_condition(statement.condition());
+        check_block(statement.then_block());
+        check_block(statement.else_block());
+    }
+
+    void check(const WhileStatement& statement) noexcept
+    {
+        check_condition(statement.condition());
+        check_block(statement.body());
+    }
+
+    void check(const ForStatement& statement) noexcept
+    {
+        // The loop variable is only visible inside the loop
+        m_environment.enter_scope();
+        check_statement(statement.init_statement());
+        check_condition(statement.condition());
+        static_cast<void>(check_expression(statement.increment_statement()));
+        check_block(statement.body());
+        m_environment.exit_scope();
+    }
+
+    void check(const ReturnStatement& statement) noexcept
+    {
+        auto*      expression = statement.expression();
+        const auto type       = check_expression(expression);
+        if (expression == nullptr || !type.is_known()) { return; }
+
+        if (m_return_type.category == Category::VOID && type.category != Category::VOID) {
+            error(
+                fmt::format(
+                    "function '{}' returns nothing but a value of type {} is returned",
+                    m_function->name(),
+                    Typechecker::type_name(type)),
+                expression->position());
+            return;
+        }
+
+        if (!is_assignable(m_return_type, type, expression)) {
+            error(
+                fmt::format(
+                    "cannot return a value of type {} from function '{}' returning {}",
+                    Typechecker::type_name(type),
+                    m_function->name(),
+                    Typechecker::type_name(m_return_type)),
+                expression->position());
+        }
+    }
+
+    void check(const VariableStatement& statement) noexcept
+    {
+        const auto& declaration = statement.variable_declaration();
+        auto*       expression  = statement.expression();
+
+        const auto declared = Typechecker::declared_type(declaration);
+        const auto type     = check_expression(expression);
+        if (expression != nullptr && !is_assignable(declared, type, expression)) {
+            error(
+                fmt::format(
+                    "cannot initialize '{}' of type {} with a value of type {}",
+                    declaration.name,
+                    Typechecker::type_name(declared),
+                    Typechecker::type_name(type)),
+                expression->position());
+        }
+
+        m_environment.enscope(declaration);
+    }
+
+    void check(const ArrayStatement& statement) noexcept
+    {
+        const auto& declaration = statement.variable_declaration();
+
+        auto element_type = Typechecker::declared_type(declaration);
+        if (element_type.is_pointer()) { --element_type.indirection; }
+
+        for (auto* element : statement.elements()) {
+            const auto type = check_expression(element);
+            if (element != nullptr && !is_assignable(element_type, type, element)) {
+                error(
+                    fmt::format(
+                        "cannot initialize an element of '{}' of type {} with a value of type {}",
+                        declaration.name,
+                        Typechecker::type_name(element_type),
+                        Typechecker::type_name(type)),
+                    element->position());
+            }
+        }
+
+        // The extension is "[size]"
+        const std::string_view extensions = declaration.type_extensions;
+        std::size_t            size       = 0;
+        const auto [end, parse_error]     = std::from_chars(
+            extensions.data() + 1, extensions.data() + extensions.size() - 1, size);
+        if (parse_error == std::errc{} && statement.elements().size() > size &&
+            !statement.elements().empty()) {
+            error(
+                fmt::format(
+                    "too many elements to initialize '{}' of size {}, {} were given",
+                    declaration.name,
+                    size,
+                    statement.elements().size()),
+                statement.elements()[size]->position());
+        }
+
+        m_environment.enscope(declaration);
+    }
+
+    void check(const ExpressionStatement& statement) noexcept
+    {
+        static_cast<void>(check_expression(statement.expression()));
+    }
+
+    void check(const MatchStatement& statement) noexcept
+    {
+        auto*      expression = statement.expression();
+        const auto type       = check_expression(expression);
+
+        const auto is_enum = [this](const ExpressionType& candidate) {
+            if (candidate.category != Category::CUSTOM || candidate.is_pointer()) { return false; }
+            const auto* entry = m_types.find(candidate.custom_type.name);
+            return entry != nullptr && entry->type.type == Token::Type::ENUM;
+        };
+        if (expression != nullptr && type.is_known() && !is_enum(type)) {
+            error(
+                fmt::format("match expects an enum, got a value of type {}", Typechecker::type_name(type)),
+                expression->position());
+        }
+
+        for (const auto& match_case : statement.cases()) {
+            m_environment.enter_scope();
+            check_match_label(*match_case.label, match_case.destructuring);
+            check_block(match_case.body);
+            m_environment.exit_scope();
+        }
+    }
+
+    // The label's arguments name the variant's fields instead of being
+    // expressions, they are bound with the fields' types
+    void check_match_label(EnumExpression& label, const std::vector<std::string>& destructuring) noexcept
+    {
+        const auto* enum_statement = enum_of(label);
+        if (enum_statement == nullptr) { return; }
+
+        const auto* fields = variant_fields(*enum_statement, label);
+        if (fields == nullptr) { return; }
+
+        if (!destructuring.empty() && destructuring.size() != fields->size()) {
+            error(
+                fmt::format(
+                    "variant '{}::{}' has {} fields but {} are destructured",
+                    enum_statement->name(),
+                    variant_name(label),
+                    fields->size(),
+                    destructuring.size()),
+                label.position());
+        }
+
+        for (std::size_t i = 0; i < std::min(destructuring.size(), fields->size()); ++i) {
+            m_environment.enscope(Typechecker::VariableDeclaration{
+                .is_mutable      = false,
+                .type            = (*fields)[i],
+                .type_extensions = "",
+                .name            = Symbol::intern(destructuring[i]),
+            });
+        }
+    }
+
+    void check_condition(Expression* condition) noexcept
+    {
+        const auto type = check_expression(condition);
+        if (condition != nullptr && is_non_scalar(type)) {
+            error(
+                fmt::format("condition must be a scalar, got a value of type {}", Typechecker::type_name(type)),
+                condition->position());
+        }
+    }
+
+    // Assigning to an immutable variable, or to a field of one, is rejected.
+    // Immutable pointers only point to constant data, they can still be
+    // assigned themselves.
+    void check_mutable(const Expression* target, const Position position) noexcept
+    {
+        while (target != nullptr) {
+            if (const auto* grouping = target->as<GroupingExpression>()) {
+                target = grouping->expression();
+            } else if (const auto* binary = target->as<BinaryExpression>();
+                       binary != nullptr && binary->operator_type() == Token::Type::DOT) {
+                target = binary->left();
+            } else {
+                break;
+            }
+        }
+
+        const auto* variable = target != nullptr ? target->as<VariableExpression>() : nullptr;
+        if (variable == nullptr) { return; }
+
+        const auto* declaration = m_environment.find(variable->name());
+        if (declaration != nullptr && !declaration->is_mutable &&
+            !Typechecker::declared_type(*declaration).is_pointer()) {
+            error(fmt::format("cannot assign to immutable variable '{}'", variable->name()), position);
+        }
+    }
+
+    // Expressions
+
+    ExpressionType check_expression(Expression* expression) noexcept
+    {
+        if (expression == nullptr) { return ExpressionType::unknown(); }
+
+        const auto type = expression->visit([this](auto& node) { return infer(node); });
+        expression->set_type(type);
+        return type;
+    }
+
+    ExpressionType infer(UnaryExpression& expression) noexcept
+    {
+        const auto type = check_expression(expression.right());
+
+        switch (expression.operator_type()) {
+            case Token::Type::AMPERSAND: {
+                if (!type.is_known()) { return type; }
+
+                auto pointer = type;
+                ++pointer.indirection;
+                return pointer;
+            }
+            case Token::Type::STAR: {
+                if (!type.is_known()) { return type; }
+                if (!type.is_pointer()) {
+                    error(
+                        fmt::format(
+                            "cannot dereference a value of type {}", Typechecker::type_name(type)),
+                        expression.position());
+                    return ExpressionType::unknown();
+                }
+
+                auto pointee = type;
+                --pointee.indirection;
+                return pointee;
+            }
+            default: {
+                if (is_non_scalar(type)) {
+                    error(
+                        fmt::format(
+                            "invalid operand of type {} to unary '{}'",
+                            Typechecker::type_name(type),
+                            expression.operator_type()),
+                        expression.position());
+                    return ExpressionType::unknown();
+                }
+
+                if (expression.operator_type() == Token::Type::PLUS_PLUS) {
+                    check_mutable(expression.right(), expression.position());
+                }
+                return expression.operator_type() == Token::Type::BANG ? ExpressionType::boolean()
+                                                                       : type;
+            }
+        }
+    }
+
+    ExpressionType infer(VariableExpression& expression) noexcept
+    {
+        // Names not declared in dl come from C headers
+        const auto* declaration = m_environment.find(expression.name());
+        if (declaration == nullptr) { return ExpressionType::unknown(); }
+        return Typechecker::declared_type(*declaration);
+    }
+
+    ExpressionType infer(BinaryExpression& expression) noexcept
+    {
+        switch (expression.operator_type()) {
+            case Token::Type::DOT:
+            case Token::Type::ARROW: {
+                return infer_field_access(expression);
+            }
+            case Token::Type::COLON_COLON: {
+                // Only enum accesses have their own node, anything else is
+                // left to the C++ compiler
+                if (auto* call = expression.right()->as<FunctionCallExpression>()) {
+                    for (auto* argument : call->arguments()) { static_cast<void>(check_expression(argument)); }
+                }
+                return ExpressionType::unknown();
+            }
+            default: {
+                break;
+            }
+        }
+
+        const auto left  = check_expression(expression.left());
+        const auto right = check_expression(expression.right());
+
+        if (is_non_scalar(left) || is_non_scalar(right)) {
+            error(
+                fmt::format(
+                    "invalid operands of types {} and {} to binary '{}'",
+                    Typechecker::type_name(left),
+                    Typechecker::type_name(right),
+                    expression.operator_type()),
+                expression.position());
+            return ExpressionType::unknown();
+        }
+
+        const auto is_arithmetic = expression.operator_type() == Token::Type::PLUS ||
+                                   expression.operator_type() == Token::Type::MINUS ||
+                                   expression.operator_type() == Token::Type::STAR ||
+                                   expression.operator_type() == Token::Type::SLASH;
+        return is_arithmetic ? Typechecker::common_type(left, right) : ExpressionType::boolean();
+    }
+
+    ExpressionType infer_field_access(BinaryExpression& expression) noexcept
+    {
+        const auto left = check_expression(expression.left());
+
+        // Method calls are not modelled, their arguments still are
+        auto* field = expression.right()->as<VariableExpression>();
+        if (field == nullptr) {
+            if (auto* call = expression.right()->as<FunctionCallExpression>()) {
+                for (auto* argument : call->arguments()) { static_cast<void>(check_expression(argument)); }
+            }
+            return ExpressionType::unknown();
+        }
+
+        if (!left.is_known()) { return ExpressionType::unknown(); }
+
+        const auto* entry = left.category == Category::CUSTOM ? m_types.find(left.custom_type.name) : nullptr;
+        if (entry != nullptr && entry->type.type == Token::Type::ENUM) {
+            return ExpressionType::unknown();
+        }
+
+        const auto is_arrow = expression.operator_type() == Token::Type::ARROW;
+        if (entry == nullptr || left.indirection != (is_arrow ? 1 : 0)) {
+            error(
+                fmt::format(
+                    "cannot access field '{}' with '{}' on a value of type {}",
+                    field->name(),
+                    expression.operator_type(),
+                    Typechecker::type_name(left)),
+                expression.position());
+            return ExpressionType::unknown();
+        }
+
+        const auto& members = entry->statement->as<StructStatement>()->member_variables();
+        const auto  member  = std::ranges::find(members, field->name(), &Typechecker::VariableDeclaration::name);
+        if (member == members.end()) {
+            error(
+                fmt::format("struct {} has no field '{}'", left.custom_type.name, field->name()),
+                field->position());
+            return ExpressionType::unknown();
+        }
+
+        const auto type = Typechecker::declared_type(*member);
+        field->set_type(type);
+        return type;
+    }
+
+    ExpressionType infer(LiteralExpression& expression) noexcept
+    {
+        switch (expression.literal_type()) {
+            case Token::Type::NUMBER: {
+                return integer_literal_type(expression.literal());
+            }
+            case Token::Type::TRUE:
+            case Token::Type::FALSE: {
+                return ExpressionType::boolean();
+            }
+            case Token::Type::SINGLE_QUOTED_STRING: {
+                return ExpressionType::builtin(BuiltinType::CHAR);
+            }
+            case Token::Type::DOUBLE_QUOTED_STRING: {
+                return ExpressionType::builtin(BuiltinType::CHAR, 1);
+            }
+            default: {
+                return ExpressionType::unknown();
+            }
+        }
+    }
+
+    ExpressionType infer(FunctionCallExpression& expression) noexcept
+    {
+        std::vector<ExpressionType> argument_types;
+        argument_types.reserve(expression.arguments().size());
+        for (auto* argument : expression.arguments()) {
+            argument_types.push_back(check_expression(argument));
+        }
+
+        // Only calls to dl functions not shadowed by a variable are checked,
+        // C functions are left to the C++ compiler
+        const auto* callee = expression.function_name()->as<VariableExpression>();
+        if (callee == nullptr || m_environment.find(callee->name()) != nullptr) {
+            static_cast<void>(check_expression(expression.function_name()));
+            return ExpressionType::unknown();
+        }
+
+        const auto found = m_functions.find(callee->name());
+        if (found == m_functions.end()) { return ExpressionType::unknown(); }
+
+        const auto& function   = *found->second;
+        const auto& parameters = function.args();
+        if (parameters.size() != argument_types.size()) {
+            error(
+                fmt::format(
+                    "function '{}' takes {} arguments but {} were given",
+                    function.name(),
+                    parameters.size(),
+                    argument_types.size()),
+                expression.position());
+            return return_type(function);
+        }
+
+        for (std::size_t i = 0; i < parameters.size(); ++i) {
+            const auto parameter_type = Typechecker::declared_type(parameters[i]);
+            if (!is_assignable(parameter_type, argument_types[i], expression.arguments()[i])) {
+                error(
+                    fmt::format(
+                        "argument '{}' of function '{}' expects {}, got a value of type {}",
+                        parameters[i].name,
+                        function.name(),
+                        Typechecker::type_name(parameter_type),
+                        Typechecker::type_name(argument_types[i])),
+                    expression.arguments()[i]->position());
+            }
+        }
+
+        return return_type(function);
+    }
+
+    ExpressionType infer(IndexOperatorExpression& expression) noexcept
+    {
+        const auto type  = check_expression(expression.variable_name());
+        const auto index = check_expression(expression.index());
+
+        if (index.is_known() && (index.is_pointer() || !index.is_scalar())) {
+            error(
+                fmt::format("array index must be an integer, got a value of type {}", Typechecker::type_name(index)),
+                expression.index()->position());
+        }
+
+        if (!type.is_known()) { return type; }
+        if (!type.is_pointer()) {
+            error(
+                fmt::format("cannot index a value of type {}", Typechecker::type_name(type)),
+                expression.position());
+            return ExpressionType::unknown();
+        }
+
+        auto element = type;
+        --element.indirection;
+        return element;
+    }
+
+    ExpressionType infer(AssignmentExpression& expression) noexcept
+    {
+        const auto target = check_expression(expression.lhs());
+        const auto value  = check_expression(expression.rhs());
+
+        check_mutable(expression.lhs(), expression.position());
+
+        const auto is_compound = expression.operator_type() != Token::Type::EQUAL;
+        const auto is_valid = is_compound ? !is_non_scalar(target) && !is_non_scalar(value)
+                                          : is_assignable(target, value, expression.rhs());
+        if (!is_valid) {
+            error(
+                fmt::format(
+                    "cannot assign a value of type {} to a target of type {} with '{}'",
+                    Typechecker::type_name(value),
+                    Typechecker::type_name(target),
+                    expression.operator_type()),
+                expression.position());
+        }
+
+        return target;
+    }
+
+    ExpressionType infer(LogicalExpression& expression) noexcept
+    {
+        const auto left  = check_expression(expression.left());
+        const auto right = check_expression(expression.right());
+
+        if (is_non_scalar(left) || is_non_scalar(right)) {
+            error(
+                fmt::format(
+                    "invalid operands of types {} and {} to a logical operator",
+                    Typechecker::type_name(left),
+                    Typechecker::type_name(right)),
+                expression.position());
+        }
+
+        return ExpressionType::boolean();
+    }
+
+    ExpressionType infer(GroupingExpression& expression) noexcept
+    {
+        return check_expression(expression.expression());
+    }
+
+    ExpressionType infer(EnumExpression& expression) noexcept
+    {
+        const auto* enum_statement = enum_of(expression);
+        if (enum_statement == nullptr) { return ExpressionType::unknown(); }
+
+        const auto enum_type = ExpressionType::custom(
+            Typechecker::CustomType(Symbol::intern(enum_statement->name()), Token::Type::ENUM));
+        expression.enum_base()->set_type(enum_type);
+
+        const auto* fields = variant_fields(*enum_statement, expression);
+        if (fields == nullptr) { return enum_type; }
+
+        // A variant without fields may be written with or without parentheses
+        auto* call = expression.enum_variant()->as<FunctionCallExpression>();
+        if (call == nullptr) { return enum_type; }
+
+        std::vector<ExpressionType> argument_types;
+        for (auto* argument : call->arguments()) {
+            argument_types.push_back(check_expression(argument));
+        }
+
+        if (argument_types.size() != fields->size()) {
+            error(
+                fmt::format(
+                    "variant '{}::{}' takes {} values but {} were given",
+                    enum_statement->name(),
+                    variant_name(expression),
+                    fields->size(),
+                    argument_types.size()),
+                call->position());
+            return enum_type;
+        }
+
+        for (std::size_t i = 0; i < fields->size(); ++i) {
+            const auto field_type = Typechecker::declared_type(Typechecker::VariableDeclaration{
+                .is_mutable      = false,
+                .type            = (*fields)[i],
+                .type_extensions = "",
+                .name            = Symbol{},
+            });
+            if (!is_assignable(field_type, argument_types[i], call->arguments()[i])) {
+                error(
+                    fmt::format(
+                        "value {} of variant '{}::{}' expects {}, got a value of type {}",
+                        i,
+                        enum_statement->name(),
+                        variant_name(expression),
+                        Typechecker::type_name(field_type),
+                        Typechecker::type_name(argument_types[i])),
+                    call->arguments()[i]->position());
+            }
+        }
+
+        return enum_type;
+    }
+
+    [[nodiscard]] const EnumStatement* enum_of(const EnumExpression& expression) const noexcept
+    {
+        const auto* base = expression.enum_base()->as<VariableExpression>();
+        if (base == nullptr) { return nullptr; }
+
+        const auto* entry = m_types.find(base->name());
+        if (entry == nullptr || entry->type.type != Token::Type::ENUM) { return nullptr; }
+        return entry->statement->as<EnumStatement>();
+    }
+
+    [[nodiscard]] static Symbol variant_name(const EnumExpression& expression) noexcept
+    {
+        const auto* variant = expression.enum_variant();
+        if (const auto* call = variant->as<FunctionCallExpression>()) {
+            variant = call->function_name();
+        }
+
+        const auto* name = variant->as<VariableExpression>();
+        return name != nullptr ? name->name() : Symbol{};
+    }
+
+    // The fields of the variant named by `expression`, reporting unknown ones
+    [[nodiscard]] const std::vector<Typechecker::Type>*
+    variant_fields(const EnumStatement& enum_statement, const EnumExpression& expression) noexcept
+    {
+        const auto name  = variant_name(expression);
+        const auto found = enum_statement.variants().find(name);
+        if (found == enum_statement.variants().end()) {
+            error(
+                fmt::format("enum {} has no variant '{}'", enum_statement.name(), name),
+                expression.position());
+            return nullptr;
+        }
+        return &found->second;
+    }
+
+    std::shared_ptr<Supervisor>                          m_supervisor;
+    TypeRegistry                                         m_types;
+    std::unordered_map<Symbol, const FunctionStatement*> m_functions;
+    Environment                                          m_environment;
+    const FunctionStatement*                             m_function    = nullptr;
+    ExpressionType                                       m_return_type = ExpressionType::unknown();
+};
+
+} // namespace
+
+void Typechecker::check(
+    const std::span<ModuleStatement* const> modules,
+    const std::shared_ptr<Supervisor>&      supervisor) noexcept
+{
+    Checker checker(supervisor);
+    checker.check(modules);
+}
+
+Typechecker::ExpressionType
+Typechecker::declared_type(const VariableDeclaration& variable_declaration) noexcept
+{
+    const auto& extensions  = variable_declaration.type_extensions;
+    const auto  indirection = static_cast<std::uint8_t>(
+        std::ranges::count(extensions, '*') + std::ranges::count(extensions, '['));
+
+    const auto type = variable_declaration.type.variant();
+    if (const auto* custom_type = std::get_if<CustomType>(&type)) {
+        return ExpressionType::custom(*custom_type, indirection);
+    }
+
+    const auto builtin = std::get<BuiltinType>(type);
+    if (builtin == BuiltinType::NONE) { return ExpressionType::unknown(); }
+    return ExpressionType::builtin(builtin, indirection);
+}
+
+std::string Typechecker::type_name(const ExpressionType& type) noexcept
+{
+    std::string name;
+    switch (type.category) {
+        case ExpressionType::Category::UNKNOWN: {
+            name = "unknown";
+            break;
+        }
+        case ExpressionType::Category::VOID: {
+            name = "void";
+            break;
+        }
+        case ExpressionType::Category::BOOLEAN: {
+            name = "bool";
+            break;
+        }
+        case ExpressionType::Category::BUILTIN: {
+            name = builtin_type_to_string(type.builtin_type);
+            break;
+        }
+        case ExpressionType::Category::CUSTOM: {
+            name = type.custom_type.name.name();
+            break;
+        }
+    }
+
+    name.append(type.indirection, '*');
+    return name;
+}
+
+Typechecker::ExpressionType
+Typechecker::common_type(const ExpressionType& lhs, const ExpressionType& rhs) noexcept
+{
+    if (!lhs.is_known() || !rhs.is_known()) { return ExpressionType::unknown(); }
+
+    if (lhs.is_pointer()) { return lhs; }
+    if (rhs.is_pointer()) { return rhs; }
+
+    const auto as_builtin = [](const ExpressionType& type) {
+        return type.category == ExpressionType::Category::BOOLEAN ? BuiltinType::I32 : type.builtin_type;
+    };
+    const auto left  = as_builtin(lhs);
+    const auto right = as_builtin(rhs);
+
+    if (left == BuiltinType::F64 || right == BuiltinType::F64) {
+        return ExpressionType::builtin(BuiltinType::F64);
+    }
+    if (left == BuiltinType::F32 || right == BuiltinType::F32) {
+        return ExpressionType::builtin(BuiltinType::F32);
+    }
+
+    const auto width = std::max({builtin_type_width(left), builtin_type_width(right), 32U});
+    const auto is_unsigned_result =
+        (builtin_type_width(left) == width && is_unsigned_builtin_type(left)) ||
+        (builtin_type_width(right) == width && is_unsigned_builtin_type(right));
+
+    if (width == 64) {
+        return ExpressionType::builtin(is_unsigned_result ? BuiltinType::U64 : BuiltinType::I64);
+    }
+    return ExpressionType::builtin(is_unsigned_result ? BuiltinType::U32 : BuiltinType::I32);
+}
+
+bool Typechecker::is_valid_lvalue(const Expression* expression) noexcept
+{
+    switch (expression->kind()) {
+        case Expression::Kind::UNARY: {
+            return expression->as<UnaryExpression>()->operator_type() == Token::Type::STAR;
+        }
+        case Expression::Kind::BINARY: {
+            const auto binary_operator = expression->as<BinaryExpression>()->operator_type();
+            return binary_operator == Token::Type::DOT || binary_operator == Token::Type::ARROW;
+        }
+        case Expression::Kind::VARIABLE:
+        case Expression::Kind::INDEX_OPERATOR: {
+            return true;
+        }
+        default: {
+            return false;
+        }
+    }
+}
@@ -1,14 +1,21 @@
 #pragma once
 
 #include <cstdint>
+#include <memory>
 #include <optional>
+#include <span>
 #include <string>
+#include <string_view>
 #include <variant>
 #include <vector>
 
-#include "Expression.hpp"
+#include "Symbol.hpp"
 #include "Token.hpp"
 
+class Expression;
+class ModuleStatement;
+class Supervisor;
+
 class [[nodiscard]] Typechecker
 {
   public:
@@ -30,11 +37,11 @@ class [[nodiscard]] Typechecker
 
     struct [[nodiscard]] CustomType
     {
-        std::string name;
+        Symbol      name;
         Token::Type type;
     };
 
-    friend bool operator==(const CustomType& lhs, const CustomType& rhs) noexcept
+    friend constexpr bool operator==(const CustomType& lhs, const CustomType& rhs) noexcept
     {
         return lhs.name == rhs.name && lhs.type == rhs.type;
     }
@@ -60,10 +67,86 @@ class [[nodiscard]] Typechecker
         bool        is_mutable;
         Type        type;
         std::string type_extensions;
-        std::string name;
+        Symbol      name;
     };
 
-    [[nodiscard]] static constexpr BuiltinType builtin_type_from_string(const std::string& type) noexcept
+    // The type an expression evaluates to, with arrays counted as one level
+    // of indirection since they decay to pointers. UNKNOWN goes to whatever
+    // the checker cannot see into, names coming from C headers above all,
+    // and is compatible with every other type.
+    struct [[nodiscard]] ExpressionType
+    {
+        enum class Category : std::uint8_t
+        {
+            UNKNOWN = 0,
+            VOID,
+            BOOLEAN,
+            BUILTIN,
+            CUSTOM,
+        };
+
+        [[nodiscard]] static constexpr ExpressionType unknown() noexcept { return {}; }
+
+        [[nodiscard]] static constexpr ExpressionType void_type() noexcept
+        {
+            return {.category = Category::VOID};
+        }
+
+        [[nodiscard]] static constexpr ExpressionType boolean() noexcept
+        {
+            return {.category = Category::BOOLEAN};
+        }
+
+        [[nodiscard]] static constexpr ExpressionType
+        builtin(const BuiltinType type, const std::uint8_t indirection = 0) noexcept
+        {
+            return {.category = Category::BUILTIN, .builtin_type = type, .indirection = indirection};
+        }
+
+        [[nodiscard]] static constexpr ExpressionType
+        custom(const CustomType& type, const std::uint8_t indirection = 0) noexcept
+        {
+            return {.category = Category::CUSTOM, .indirection = indirection, .custom_type = type};
+        }
+
+        [[nodiscard]] constexpr bool is_known() const noexcept
+        {
+            return category != Category::UNKNOWN;
+        }
+
+        [[nodiscard]] constexpr bool is_pointer() const noexcept { return indirection > 0; }
+
+        // Usable in arithmetic and conditions
+        [[nodiscard]] constexpr bool is_scalar() const noexcept
+        {
+            return is_pointer() || category == Category::BOOLEAN || category == Category::BUILTIN;
+        }
+
+        friend constexpr bool operator==(const ExpressionType& lhs, const ExpressionType& rhs) noexcept
+        {
+            return lhs.category == rhs.category && lhs.builtin_type == rhs.builtin_type &&
+                   lhs.indirection == rhs.indirection && lhs.custom_type == rhs.custom_type;
+        }
+
+        Category     category     = Category::UNKNOWN;
+        BuiltinType  builtin_type = BuiltinType::NONE;
+        std::uint8_t indirection  = 0;
+        CustomType   custom_type  = {.name = Symbol{}, .type = Token::Type::MAX};
+    };
+
+    // Resolves the type of every expression in `modules`, storing it on the
+    // nodes, and reports type errors to `supervisor`
+    static void check(
+        std::span<ModuleStatement* const> modules,
+        const std::shared_ptr<Supervisor>& supervisor) noexcept;
+
+    [[nodiscard]] static ExpressionType
+    declared_type(const VariableDeclaration& variable_declaration) noexcept;
+
+    // "i32", "Matrix*" and the like, as written in dl
+    [[nodiscard]] static std::string type_name(const ExpressionType& type) noexcept;
+
+    [[nodiscard]] static constexpr BuiltinType builtin_type_from_string(const std::string_view type) noexcept
     {
         if (type == "u8") { return BuiltinType::U8; }
         if (type == "i8") { return BuiltinType::I8; }
@@ -167,6 +250,48 @@ class [[nodiscard]] Typechecker
         return builtin_type_to_c_type(builtin_type_from_string(type));
     }
 
+    // Width in bits of the C type a builtin is emitted as
+    [[nodiscard]] static constexpr unsigned builtin_type_width(const BuiltinType type) noexcept
+    {
+        switch (type) {
+            case BuiltinType::U8:
+            case BuiltinType::I8:
+            case BuiltinType::CHAR: {
+                return 8;
+            }
+            case BuiltinType::U16:
+            case BuiltinType::I16: {
+                return 16;
+            }
+            case BuiltinType::U64:
+            case BuiltinType::I64:
+            case BuiltinType::F64: {
+                return 64;
+            }
+            default: {
+                return 32;
+            }
+        }
+    }
+
+    [[nodiscard]] static constexpr bool is_unsigned_builtin_type(const BuiltinType type) noexcept
+    {
+        return type == BuiltinType::U8 || type == BuiltinType::U16 || type == BuiltinType::U32 ||
+               type == BuiltinType::U64;
+    }
+
+    [[nodiscard]] static constexpr bool is_floating_builtin_type(const BuiltinType type) noexcept
+    {
+        return type == BuiltinType::F32 || type == BuiltinType::F64;
+    }
+
+    // The type C computes a binary arithmetic operation in, after the usual
+    // arithmetic conversions: floating point wins, anything narrower than int
+    // is promoted to it and at equal width unsigned wins. Pointer arithmetic
+    // keeps the pointer.
+    [[nodiscard]] static ExpressionType
+    common_type(const ExpressionType& lhs, const ExpressionType& rhs) noexcept;
+
     [[nodiscard]] static constexpr bool is_fixed_size_array(const std::string& type_extensions) noexcept
     {
         return !type_extensions.empty() && type_extensions.front() == '[' &&
@@ -174,39 +299,20 @@ class [[nodiscard]] Typechecker
     }
 
     [[nodiscard]] static constexpr bool
-    is_valid_type(const std::string& token, const auto& custom_types) noexcept
+    is_valid_type(const std::string_view token, const auto& type_registry) noexcept
     {
-        const bool is_custom_type =
-            std::ranges::find_if(custom_types, [&](const auto& map_entry) {
-                const auto [custom_type, statement] = map_entry;
-                return custom_type.name == token;
-            }) != custom_types.end();
-
         return Typechecker::builtin_type_from_string(token) !=
                    Typechecker::BuiltinType::NONE ||
-               is_custom_type;
+               type_registry.find(token) != nullptr;
     }
 
-    [[nodiscard]] static bool is_valid_lvalue(const std::shared_ptr<Expression>& expression) noexcept
-    {
-        if (auto* const unary_expression = expression->as<UnaryExpression>()) {
-            return unary_expression->operator_type() == Token::Type::STAR;
-        }
-
-        if (auto* const binary_expression = expression->as<BinaryExpression>()) {
-            return binary_expression->operator_type() == Token::Type::DOT ||
-                   binary_expression->operator_type() == Token::Type::ARROW;
-        }
-
-        return (expression->as<VariableExpression>() != nullptr) ||
-               (expression->as<IndexOperatorExpression>() != nullptr);
-    }
+    [[nodiscard]] static bool is_valid_lvalue(const Expression* expression) noexcept;
 
     [[nodiscard]] static constexpr Type
     resolve_type(const std::string& type, const Token::Type& token_type) noexcept
     {
         return Typechecker::builtin_type_from_string(type) != Typechecker::BuiltinType::NONE
                  ? Type(Typechecker::builtin_type_from_string(type))
-                 : Type(CustomType(type, token_type));
+                 : Type(CustomType(Symbol::intern(type), token_type));
     }
 };
@@ -1,6 +1,21 @@
 #define FMT_HEADER_ONLY
 
-#include <sys/wait.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <optional>
+#include <ranges>
+#include <span>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <utility>
 
 #include <fmt/color.h>
 #include <fmt/core.h>
@@ -12,13 +27,276 @@
 #include <dtsutil/filesystem.hpp>
 #include <dtsutil/process.hpp>
 
+#include "BuildCache.hpp"
+#include "ConstantFolder.hpp"
+#include "DeadCodeEliminator.hpp"
 #include "Lexer.hpp"
+#include "ModuleBuild.hpp"
+#include "ModuleGraph.hpp"
 #include "Parser.hpp"
 #include "Supervisor.hpp"
+#include "ThreadPool.hpp"
+#include "TimeReport.hpp"
+#include "Trace.hpp"
+
+namespace
+{
+
+constexpr std::string_view dl_version = "0.0.1";
+
+// Everything but the input and output paths, part of the build cache key
+constexpr std::array<std::string_view, 2> compiler_command = {"gcc", "-xc++"};
+
+[[nodiscard]] std::vector<std::string>
+compiler_arguments(const std::string& output_file_path, const std::string_view input)
+{
+    std::vector<std::string> arguments(compiler_command.begin(), compiler_command.end());
+    arguments.emplace_back("-o");
+    arguments.push_back(output_file_path);
+    arguments.emplace_back(input);
+    return arguments;
+}
+
+// Generates the modules one at a time and hands each one's code to `sink`,
+// stops early if the sink cannot take any more
+template <typename Sink>
+void transpile(const std::vector<ModuleStatement*>& modules, Sink&& sink)
+{
+    fmt::memory_buffer buffer;
+    for (const auto* modul : modules) {
+        {
+            ScopedTimer timer(TimeReport::Phase::CODEGEN, modul->name());
+            modul->emit(buffer);
+            buffer.append(std::string_view("\n\n"));
+            timer.add_bytes(buffer.size());
+            timer.add_items(1);
+        }
+
+        ScopedTimer timer(TimeReport::Phase::WRITE);
+        timer.add_bytes(buffer.size());
+        if (!sink(std::string_view(buffer.data(), buffer.size()))) { return; }
+        buffer.clear();
+    }
+}
+
+// The name gcc reports errors in when the code is streamed to it, the root
+// file with a .gen.cpp extension, escaped for a #line directive
+[[nodiscard]] std::string generated_file_name(const std::string& project_root_file)
+{
+    const auto  name = std::filesystem::path(project_root_file).replace_extension(".gen.cpp").string();
+    std::string escaped;
+    for (const auto c : name) {
+        if (c == '"' || c == '\\') { escaped.push_back('\\'); }
+        escaped.push_back(c);
+    }
+    return escaped;
+}
+
+// Compiles the transpiled modules into `output_file_path`, either through
+// intermediate.cpp or by streaming them into gcc's stdin
+[[nodiscard]] bool compile(
+    const std::vector<ModuleStatement*>& modules,
+    const std::string&                   output_file_path,
+    const bool                           intermediate_files,
+    const std::string&                   project_root_file)
+{
+    std::expected<dts::ProcessResult, dts::ProcessError> compiler_result;
+    if (intermediate_files) {
+        const std::string intermediate_file = "intermediate.cpp";
+        std::ofstream     intermediate_file_fd(intermediate_file, std::ios::binary);
+        transpile(modules, [&intermediate_file_fd](const std::string_view code) {
+            intermediate_file_fd.write(code.data(), static_cast<std::streamsize>(code.size()));
+            return intermediate_file_fd.good();
+        });
+        intermediate_file_fd.close();
+
+        ScopedTimer timer(TimeReport::Phase::COMPILE);
+        TraceSpan   span("gcc", intermediate_file);
+        timer.add_items(1);
+        compiler_result =
+            dts::subprocess_run(compiler_arguments(output_file_path, intermediate_file));
+    } else {
+        // gcc reads the translation unit from stdin, so it starts parsing the
+        // first module while the rest are still being generated
+        dts::ProcessOptions options;
+        options.pipe_stdin = true;
+
+        // Spans the whole life of gcc, the writes into it included
+        TraceSpan span("gcc", "-");
+
+        auto compiler = dts::Process::spawn(compiler_arguments(output_file_path, "-"), options);
+        if (compiler) {
+            // A write fails with EPIPE instead of killing dl if gcc exits
+            // early, its exit code is reported below
+            std::signal(SIGPIPE, SIG_IGN);
+
+            // Without a name gcc reports errors at <stdin>:LINE:COL. Lines
+            // are counted as in the intermediate.cpp written with -I.
+            const auto line_directive = fmt::format(
+                "#line 1 \"{}\"\n", generated_file_name(project_root_file));
+            static_cast<void>(compiler->write(line_directive));
+
+            transpile(modules, [&compiler](const std::string_view code) {
+                return compiler->write(code).has_value();
+            });
+
+            // Only what is left of gcc's run once all the code is written
+            ScopedTimer timer(TimeReport::Phase::COMPILE);
+            timer.add_items(1);
+            compiler_result = compiler->wait();
+        } else {
+            compiler_result = std::unexpected(compiler.error());
+        }
+    }
+
+    if (!compiler_result) {
+        fmt::print(
+            stderr,
+            fmt::emphasis::bold | fmt::fg(fmt::color::red),
+            "error while invoking gcc to compile the transpiled file {}: {}\n",
+            project_root_file,
+            compiler_result.error().message.value_or("unknown error"));
+        return false;
+    }
+
+    if (!compiler_result->success()) {
+        fmt::print(
+            stderr,
+            fmt::emphasis::bold | fmt::fg(fmt::color::red),
+            "gcc failed to compile the transpiled file: {}{}\n",
+            project_root_file,
+            intermediate_files ? "" : ", rerun with -I to keep the generated code in intermediate.cpp");
+        return false;
+    }
+
+    return true;
+}
+
+// Compiles every module as its own translation unit on `jobs` parallel
+// compilers. The generated files are kept in intermediates/ with -I,
+// otherwise they live in a temporary directory removed afterwards.
+[[nodiscard]] bool compile_modules_separately(
+    const std::vector<ModuleStatement*>& modules,
+    const std::string&                   output_file_path,
+    const std::size_t                    jobs,
+    const bool                           intermediate_files)
+{
+    const auto work_directory =
+        intermediate_files
+            ? std::filesystem::path("intermediates")
+            : std::filesystem::temp_directory_path() / fmt::format("dl-{}", getpid());
+
+    const auto built = ModuleBuild::run(
+        modules,
+        {
+            .compiler       = compiler_command.front(),
+            .compile_flags  = std::span(compiler_command).subspan(1),
+            .work_directory = work_directory,
+            .output         = output_file_path,
+            .jobs           = jobs,
+        });
+
+    if (!intermediate_files) {
+        ScopedTimer     timer(TimeReport::Phase::CLEANUP);
+        std::error_code error;
+        std::filesystem::remove_all(work_directory, error);
+    }
+
+    return built;
+}
+
+// Tells apart dl builds sharing a version, since any change to code
+// generation changes the binaries produced. Empty where the running
+// executable cannot be found.
+[[nodiscard]] std::string dl_build_identity()
+{
+    std::error_code error;
+    const auto      executable = std::filesystem::read_symlink("/proc/self/exe", error);
+    if (error) { return {}; }
+    return BuildCache::file_identity(executable);
+}
+
+// The file posix_spawnp runs for `name`, through symlinks such as gcc ->
+// gcc-12. Empty if it is not found on $PATH.
+[[nodiscard]] std::filesystem::path find_executable(const std::string_view name)
+{
+    const auto* path = std::getenv("PATH");
+    if (path == nullptr) { return {}; }
+
+    for (const auto directory : std::string_view(path) | std::views::split(':')) {
+        const auto candidate = std::filesystem::path(std::string_view(directory)) / name;
+
+        std::error_code error;
+        if (std::filesystem::is_regular_file(candidate, error) && access(candidate.c_str(), X_OK) == 0) {
+            const auto resolved = std::filesystem::canonical(candidate, error);
+            return error ? candidate : resolved;
+        }
+    }
+    return {};
+}
+
+// The exact compiler release. Asking gcc costs a process, so the answer is
+// kept in the cache for as long as the compiler binary stays the same.
+// Empty if the compiler cannot be found or run.
+[[nodiscard]] std::string compiler_version(const BuildCache& build_cache)
+{
+    const auto compiler_identity = BuildCache::file_identity(find_executable(compiler_command.front()));
+    if (compiler_identity.empty()) { return {}; }
+
+    if (auto version = build_cache.compiler_version(compiler_identity)) { return std::move(*version); }
+
+    dts::ProcessOptions options;
+    options.capture_output = true;
+
+    const auto result =
+        dts::subprocess_run({std::string(compiler_command.front()), "-dumpfullversion"}, options);
+    if (!result || !result->success() || result->stdout_output.empty()) { return {}; }
+
+    build_cache.store_compiler_version(compiler_identity, result->stdout_output);
+    return result->stdout_output;
+}
+
+// Hashes everything the compiled binary depends on: the dl build, the
+// compiler release and invocation, whether unreachable code was kept, every
+// source file of the program and its C includes. Empty when the dl build or
+// the compiler release cannot be identified, as a key missing either could
+// return binaries built differently.
+[[nodiscard]] std::optional<std::string> compute_build_key(
+    const BuildCache&                    build_cache,
+    const Supervisor&                    supervisor,
+    const std::vector<ModuleStatement*>& modules,
+    const bool                           keep_all)
+{
+    const auto build_identity = dl_build_identity();
+    const auto version        = compiler_version(build_cache);
+    if (build_identity.empty() || version.empty()) { return std::nullopt; }
+
+    BuildCache::KeyBuilder key_builder;
+    key_builder.add(dl_version);
+    key_builder.add(build_identity);
+    key_builder.add(version);
+    for (const auto argument : compiler_command) { key_builder.add(argument); }
+    key_builder.add(keep_all ? "keep-all" : "");
+
+    // Imported modules are stored in whatever order the front end threads
+    // finished them, sorting keeps the key independent of scheduling
+    std::vector<std::string_view> sources;
+    for (const auto& source : supervisor.sources()) { sources.push_back(source.contents.view()); }
+    std::ranges::sort(sources);
+    for (const auto source : sources) { key_builder.add(source); }
+
+    for (const auto* modul : modules) {
+        for (const auto& c_include : modul->c_includes()) { key_builder.add(c_include); }
+    }
+
+    return key_builder.key();
+}
+
+} // namespace
 
 int main(int argc, char** argv)
 {
-    argparse::ArgumentParser parser("dl", "0.0.1");
+    argparse::ArgumentParser parser("dl", std::string(dl_version));
     parser.add_argument("file").help("path to dl file to transpile");
     parser.add_argument("-o", "--output").help("compiled binary output path").default_value("a.out");
     parser.add_argument("-r", "--compile-and-run")
@@ -33,6 +311,28 @@ int main(int argc, char** argv)
         .help("generate intermediate files")
         .default_value(false)
         .implicit_value(true);
+    parser.add_argument("-j", "--jobs")
+        .help("compile each module as its own translation unit, on up to N compilers at once")
+        .scan<'u', std::size_t>();
+    parser.add_argument("--no-cache")
+        .help("always compile, bypassing the build cache")
+        .default_value(false)
+        .implicit_value(true);
+    parser.add_argument("--keep-all")
+        .help("emit every function, struct and enum, even those main never reaches")
+        .default_value(false)
+        .implicit_value(true);
+    parser.add_argument("--cache-dir").help("build cache directory, defaults to $XDG_CACHE_HOME/dl");
+    parser.add_argument("--cache-size")
+        .help("size in MiB past which the least recently used cached binaries are removed")
+        .default_value(static_cast<std::size_t>(BuildCache::default_max_size >> 20))
+        .scan<'u', std::size_t>();
+    parser.add_argument("--time-report")
+        .help("print the time, volume and allocations of each phase to stderr")
+        .default_value(false)
+        .implicit_value(true);
+    parser.add_argument("--trace-out")
+        .help("write a Chrome trace-event JSON of the compilation to the given path");
     parser.add_argument("-T", "--tokens")
         .help("print lexed tokens to stdout")
         .default_value(false)
@@ -47,20 +347,50 @@ int main(int argc, char** argv)
         return 1;
     }
 
+    if (parser.get<bool>("--time-report")) {
+        TimeReport::enable();
+        std::atexit([] { TimeReport::print(stderr); });
+    }
+
+    static std::string trace_file;
+    if (const auto trace_out = parser.present("--trace-out")) {
+        trace_file = *trace_out;
+        Trace::enable();
+        std::atexit([] {
+            if (!Trace::write(trace_file)) {
+                fmt::print(
+                    stderr,
+                    fmt::emphasis::bold | fmt::fg(fmt::color::red),
+                    "error while writing the trace to {}\n",
+                    trace_file);
+            }
+        });
+    }
+
     const auto project_root_file = parser.get<std::string>("file");
 
-    const auto file_content = dts::read_file(project_root_file);
+    const auto root_file_name = std::filesystem::path(project_root_file).filename().string();
+
+    auto read_timer   = std::make_optional<ScopedTimer>(TimeReport::Phase::READ, root_file_name);
+    auto file_content = dts::map_file(project_root_file);
     if (!file_content.has_value()) {
         fmt::print(
             stderr,
             fmt::emphasis::bold | fmt::fg(fmt::color::red),
             "{}",
             file_content.error());
+        return 1;
     }
+    read_timer->add_bytes(file_content->view().size());
+    read_timer.reset();
 
-    const auto supervisor = Supervisor::create(file_content.value(), project_root_file);
+    const auto supervisor = Supervisor::create(std::move(*file_content), project_root_file);
 
-    const auto tokens = Lexer::lex(file_content.value(), supervisor);
+    auto       lex_timer = std::make_optional<ScopedTimer>(TimeReport::Phase::LEX, root_file_name);
+    const auto tokens    = Lexer::lex(Supervisor::root_source_id, supervisor);
+    lex_timer->add_bytes(supervisor->root_source().size());
+    lex_timer->add_items(tokens.size());
+    lex_timer.reset();
     if (supervisor->has_errors()) {
         supervisor->dump_errors();
         return 1;
@@ -71,59 +401,90 @@ int main(int argc, char** argv)
         for (const auto& token : tokens) { fmt::println(stderr, "{}", token); }
     }
 
-    const auto modules = Parser::parse(tokens, supervisor);
+    // Owns the whole AST, released in one go when main returns. Imports are
+    // loaded on as many threads as modules are compiled with.
+    const auto  jobs = parser.present<std::size_t>("--jobs");
+    ModuleGraph module_graph(supervisor, jobs.value_or(ThreadPool::default_thread_count()));
+
+    const auto modules = module_graph.build(tokens);
     if (supervisor->has_errors()) {
         supervisor->dump_errors();
         return 1;
     }
 
-    const auto transpiled_file_content = std::accumulate(
-        modules.begin(), modules.end(), std::string{}, [](const auto& acc, const auto& modul) {
-            return acc + fmt::format("{}\n\n", modul.evaluate());
-        });
+    {
+        ScopedTimer timer(TimeReport::Phase::TYPECHECK);
+        Typechecker::check(modules, supervisor);
+    }
+    if (supervisor->has_errors()) {
+        supervisor->dump_errors();
+        return 1;
+    }
+
+    // The literals replacing folded expressions live as long as the tree
+    Arena folded_nodes;
+    {
+        ScopedTimer timer(TimeReport::Phase::FOLD);
+        timer.add_items(ConstantFolder::fold(modules, folded_nodes));
+    }
+
+    const auto keep_all = parser.get<bool>("--keep-all");
+    if (!keep_all) {
+        ScopedTimer timer(TimeReport::Phase::ELIMINATE);
+        timer.add_items(DeadCodeEliminator::eliminate(modules));
+    }
 
     const auto output_to_stdout = parser.get<bool>("--output-to-stdout");
     if (output_to_stdout) {
-        fmt::print("{}", transpiled_file_content);
+        transpile(modules, [](const std::string_view code) {
+            return std::fwrite(code.data(), 1, code.size(), stdout) == code.size();
+        });
         return 0;
     }
 
-    const std::string intermediate_file = "intermediate.cpp";
-    std::ofstream     intermediate_file_fd(intermediate_file);
-    intermediate_file_fd << transpiled_file_content;
-    intermediate_file_fd.close();
+    const auto output_file_path   = parser.get<std::string>("--output");
+    const auto intermediate_files = parser.get<bool>("--intermediates");
 
-    const auto output_file_path       = parser.get<std::string>("--output");
-    const auto compile_process_result = dts::subprocess_run(
-        fmt::format("gcc -o {} -xc++ {}", output_file_path, intermediate_file));
-    if (!compile_process_result) {
-        fmt::print(
-            stderr,
-            fmt::emphasis::bold | fmt::fg(fmt::color::red),
-            "error while invoking gcc to compile the transpiled file: {}",
-            project_root_file);
-        return 1;
+    // A binary cached from identical inputs makes the gcc step unnecessary.
+    // Intermediate files are only produced by actually compiling.
+    std::optional<BuildCache> build_cache;
+    std::string               build_key;
+    if (!intermediate_files && !parser.get<bool>("--no-cache")) {
+        const auto cache_directory = parser.present("--cache-dir");
+        const auto cache_size      = std::uintmax_t{parser.get<std::size_t>("--cache-size")} << 20;
+        build_cache                = BuildCache::open(
+            cache_directory ? std::filesystem::path(*cache_directory) : BuildCache::default_directory(),
+            cache_size);
+        if (build_cache) {
+            ScopedTimer timer(TimeReport::Phase::CACHE);
+            if (auto key = compute_build_key(*build_cache, *supervisor, modules, keep_all)) {
+                build_key = std::move(*key);
+            } else {
+                build_cache.reset();
+            }
+        }
     }
 
-    int _status = 0;
-    wait(&_status);
+    const auto cache_hit = build_cache && [&] {
+        ScopedTimer timer(TimeReport::Phase::CACHE);
+        return build_cache->restore(build_key, output_file_path);
+    }();
 
-    const auto intermediate_files = parser.get<bool>("--intermediates");
-    if (!intermediate_files) {
-        const auto cleanup_process_result =
-            dts::subprocess_run(fmt::format("rm {}", intermediate_file));
-        if (!cleanup_process_result) {
-            fmt::print(stderr, fmt::emphasis::bold | fmt::fg(fmt::color::red), "error while cleaning up intermediate files");
-            return 1;
+    if (!cache_hit) {
+        const auto built = jobs ? compile_modules_separately(
+                                      modules, output_file_path, *jobs, intermediate_files)
+                                : compile(modules, output_file_path, intermediate_files, project_root_file);
+        if (!built) { return 1; }
+        if (build_cache) {
+            ScopedTimer timer(TimeReport::Phase::CACHE);
+            build_cache->store(build_key, output_file_path);
         }
     }
 
-    wait(&_status);
-
     const auto compile_and_run = parser.get<bool>("--compile-and-run");
     if (compile_and_run) {
         const auto run_process_result =
-            dts::subprocess_run(fmt::format("./{}", output_file_path));
+            dts::subprocess_run({std::filesystem::absolute(output_file_path).string()});
         if (!run_process_result) {
             fmt::print(
                 stderr,
@@ -132,6 +493,9 @@ int main(int argc, char** argv)
                 project_root_file);
             return 1;
         }
+
+        // The program's exit code becomes dl's
+        return run_process_result->exit_code;
     }
 
     return 0;